@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ALGO_BIGINT_BATCH_X86
+#endif
+
+#include "batch.h"
+
+
+#define assert(x) if (!(x)) throw std::invalid_argument(#x)
+
+
+//a lane kernel handles whole vectors of lanes from the first one and
+//returns how many lanes it covered; the scalar loops finish the rest
+typedef size_t (*lane_kernel)(int n, size_t count, const uint32_t *u, const uint32_t *v, uint32_t *w);
+
+
+//algorithm_a down each lane
+static void
+add_lanes(int n, size_t count, size_t from, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	uint32_t sum_a, sum_b;
+	bool carry, carry_a, carry_b;
+
+	for (size_t i = from; i < count; i++) {
+		carry = false;
+
+		for (int j = 0; j < n; j++) {
+			sum_a = u[j * count + i] + v[j * count + i];
+			carry_a = (sum_a < u[j * count + i]);
+
+			sum_b = sum_a + carry;
+			carry_b = (sum_b < sum_a);
+
+			w[j * count + i] = sum_b;
+			carry = carry_a || carry_b;
+		}
+	}
+}
+
+
+//algorithm_s down each lane
+static void
+sub_lanes(int n, size_t count, size_t from, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	uint32_t diff_a, diff_b;
+	bool borrow, borrow_a, borrow_b;
+
+	for (size_t i = from; i < count; i++) {
+		borrow = false;
+
+		for (int j = 0; j < n; j++) {
+			diff_a = u[j * count + i] - v[j * count + i];
+			borrow_a = (diff_a > u[j * count + i]);
+
+			diff_b = diff_a - borrow;
+			borrow_b = (diff_b > diff_a);
+
+			w[j * count + i] = diff_b;
+			borrow = borrow_a || borrow_b;
+		}
+	}
+}
+
+
+//algorithm_m down each lane, accumulating into w and dropping the
+//partial products past the top limb
+static void
+mul_add_lanes(int n, size_t count, size_t from, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	uint64_t t;
+	uint32_t k;
+
+	for (size_t i = from; i < count; i++) {
+		for (int a = 0; a < n; a++) {
+			k = 0;
+
+			for (int b = 0; a + b < n; b++) {
+				t = (uint64_t)u[a * count + i] * v[b * count + i] + w[(a + b) * count + i] + k;
+				w[(a + b) * count + i] = (uint32_t)t;
+				k = (uint32_t)(t >> 32);
+			}
+		}
+	}
+}
+
+
+static size_t
+no_lanes(int n, size_t count, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	return 0;
+}
+
+
+#ifdef ALGO_BIGINT_BATCH_X86
+
+//AVX2 has no unsigned compare, so carries come from signed compares of
+//values with the top bit flipped, kept as all-ones masks
+__attribute__((target("avx2")))
+static size_t
+add_avx2(int n, size_t count, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+	__m256i a, b, s, t, carry, c1, c2;
+	size_t i;
+
+	for (i = 0; i + 8 <= count; i += 8) {
+		carry = _mm256_setzero_si256();
+
+		for (int j = 0; j < n; j++) {
+			a = _mm256_loadu_si256((const __m256i *)(u + j * count + i));
+			b = _mm256_loadu_si256((const __m256i *)(v + j * count + i));
+
+			s = _mm256_add_epi32(a, b);
+			c1 = _mm256_cmpgt_epi32(_mm256_xor_si256(a, bias), _mm256_xor_si256(s, bias));
+
+			t = _mm256_sub_epi32(s, carry);
+			c2 = _mm256_cmpgt_epi32(_mm256_xor_si256(s, bias), _mm256_xor_si256(t, bias));
+
+			_mm256_storeu_si256((__m256i *)(w + j * count + i), t);
+			carry = _mm256_or_si256(c1, c2);
+		}
+	}
+
+	return i;
+}
+
+
+__attribute__((target("avx2")))
+static size_t
+sub_avx2(int n, size_t count, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+	__m256i a, b, d, t, borrow, b1, b2;
+	size_t i;
+
+	for (i = 0; i + 8 <= count; i += 8) {
+		borrow = _mm256_setzero_si256();
+
+		for (int j = 0; j < n; j++) {
+			a = _mm256_loadu_si256((const __m256i *)(u + j * count + i));
+			b = _mm256_loadu_si256((const __m256i *)(v + j * count + i));
+
+			d = _mm256_sub_epi32(a, b);
+			b1 = _mm256_cmpgt_epi32(_mm256_xor_si256(b, bias), _mm256_xor_si256(a, bias));
+
+			t = _mm256_add_epi32(d, borrow);
+			b2 = _mm256_cmpgt_epi32(_mm256_xor_si256(t, bias), _mm256_xor_si256(d, bias));
+
+			_mm256_storeu_si256((__m256i *)(w + j * count + i), t);
+			borrow = _mm256_or_si256(b1, b2);
+		}
+	}
+
+	return i;
+}
+
+
+//four lanes at a time widened to 64 bits, where a limb product plus two
+//limbs cannot overflow
+__attribute__((target("avx2")))
+static size_t
+mul_add_avx2(int n, size_t count, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	const __m256i pack = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+	__m256i x, y, z, t, k;
+	size_t i;
+
+	for (i = 0; i + 4 <= count; i += 4) {
+		for (int a = 0; a < n; a++) {
+			x = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(u + a * count + i)));
+			k = _mm256_setzero_si256();
+
+			for (int b = 0; a + b < n; b++) {
+				y = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(v + b * count + i)));
+				z = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(w + (a + b) * count + i)));
+
+				t = _mm256_add_epi64(_mm256_add_epi64(_mm256_mul_epu32(x, y), z), k);
+
+				_mm_storeu_si128((__m128i *)(w + (a + b) * count + i),
+						_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(t, pack)));
+				k = _mm256_srli_epi64(t, 32);
+			}
+		}
+	}
+
+	return i;
+}
+
+
+//GCC 12 warns about the placeholder operands inside its own AVX-512
+//intrinsics once they are inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f")))
+static size_t
+add_avx512(int n, size_t count, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	const __m512i one = _mm512_set1_epi32(1);
+	__m512i a, b, s, t;
+	__mmask16 carry;
+	size_t i;
+
+	for (i = 0; i + 16 <= count; i += 16) {
+		carry = 0;
+
+		for (int j = 0; j < n; j++) {
+			a = _mm512_loadu_si512(u + j * count + i);
+			b = _mm512_loadu_si512(v + j * count + i);
+
+			s = _mm512_add_epi32(a, b);
+			t = _mm512_mask_add_epi32(s, carry, s, one);
+
+			_mm512_storeu_si512(w + j * count + i, t);
+			carry = _mm512_cmplt_epu32_mask(s, a) | _mm512_cmplt_epu32_mask(t, s);
+		}
+	}
+
+	return i;
+}
+
+
+__attribute__((target("avx512f")))
+static size_t
+sub_avx512(int n, size_t count, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	const __m512i one = _mm512_set1_epi32(1);
+	__m512i a, b, d, t;
+	__mmask16 borrow;
+	size_t i;
+
+	for (i = 0; i + 16 <= count; i += 16) {
+		borrow = 0;
+
+		for (int j = 0; j < n; j++) {
+			a = _mm512_loadu_si512(u + j * count + i);
+			b = _mm512_loadu_si512(v + j * count + i);
+
+			d = _mm512_sub_epi32(a, b);
+			t = _mm512_mask_sub_epi32(d, borrow, d, one);
+
+			_mm512_storeu_si512(w + j * count + i, t);
+			borrow = _mm512_cmplt_epu32_mask(a, b) | _mm512_cmplt_epu32_mask(d, t);
+		}
+	}
+
+	return i;
+}
+
+
+__attribute__((target("avx512f")))
+static size_t
+mul_add_avx512(int n, size_t count, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	__m512i x, y, z, t, k;
+	size_t i;
+
+	for (i = 0; i + 8 <= count; i += 8) {
+		for (int a = 0; a < n; a++) {
+			x = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i *)(u + a * count + i)));
+			k = _mm512_setzero_si512();
+
+			for (int b = 0; a + b < n; b++) {
+				y = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i *)(v + b * count + i)));
+				z = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i *)(w + (a + b) * count + i)));
+
+				t = _mm512_add_epi64(_mm512_add_epi64(_mm512_mul_epu32(x, y), z), k);
+
+				_mm256_storeu_si256((__m256i *)(w + (a + b) * count + i), _mm512_cvtepi64_epi32(t));
+				k = _mm512_srli_epi64(t, 32);
+			}
+		}
+	}
+
+	return i;
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+
+struct batch_kernels {
+	lane_kernel add, sub, mul_add;
+};
+
+
+//picked once from what the processor supports
+static const batch_kernels &
+kernels()
+{
+	static const batch_kernels chosen = [] {
+		batch_kernels k = { no_lanes, no_lanes, no_lanes };
+
+#ifdef ALGO_BIGINT_BATCH_X86
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx512f")) {
+			k = { add_avx512, sub_avx512, mul_add_avx512 };
+		} else if (__builtin_cpu_supports("avx2")) {
+			k = { add_avx2, sub_avx2, mul_add_avx2 };
+		}
+#endif
+
+		return k;
+	}();
+
+	return chosen;
+}
+
+
+algo::bigint::Batch::Batch(int limbs, size_t count)
+: width(limbs), count(count), repr((size_t)limbs * count, 0)
+{
+	assert(limbs > 0 && "A batch needs at least one limb.");
+}
+
+
+algo::bigint::BigInt
+algo::bigint::Batch::get(size_t i) const
+{
+	Limbs x(width);
+
+	for (int j = 0; j < width; j++) {
+		x[j] = row(j)[i];
+	}
+
+	return BigInt(std::move(x), false);
+}
+
+
+void
+algo::bigint::Batch::set(size_t i, const BigInt &value)
+{
+	const Limbs &limbs = value.limbs();
+	bool carry = value.is_negative();
+	uint32_t x;
+
+	for (int j = 0; j < width; j++) {
+		x = (j < (int)limbs.size()) ? limbs[j] : 0;
+
+		//two's complement of a negative value, ~x + 1
+		if (value.is_negative()) {
+			x = ~x + carry;
+			carry = carry && x == 0;
+		}
+
+		row(j)[i] = x;
+	}
+}
+
+
+static void
+check_shapes(const algo::bigint::Batch &u, const algo::bigint::Batch &v, const algo::bigint::Batch &w)
+{
+	assert(u.limbs() == v.limbs() && u.limbs() == w.limbs() && "Batch widths differ!");
+	assert(u.size() == v.size() && u.size() == w.size() && "Batch sizes differ!");
+}
+
+
+void
+algo::bigint::batch_add(const Batch &u, const Batch &v, Batch &w)
+{
+	size_t done;
+
+	check_shapes(u, v, w);
+
+	done = kernels().add(u.limbs(), u.size(), u.row(0), v.row(0), w.row(0));
+	add_lanes(u.limbs(), u.size(), done, u.row(0), v.row(0), w.row(0));
+}
+
+
+void
+algo::bigint::batch_sub(const Batch &u, const Batch &v, Batch &w)
+{
+	size_t done;
+
+	check_shapes(u, v, w);
+
+	done = kernels().sub(u.limbs(), u.size(), u.row(0), v.row(0), w.row(0));
+	sub_lanes(u.limbs(), u.size(), done, u.row(0), v.row(0), w.row(0));
+}
+
+
+void
+algo::bigint::batch_mul_add(const Batch &u, const Batch &v, Batch &w)
+{
+	size_t done;
+
+	check_shapes(u, v, w);
+	assert(&w != &u && &w != &v && "Product may not overwrite an operand!");
+
+	done = kernels().mul_add(u.limbs(), u.size(), u.row(0), v.row(0), w.row(0));
+	mul_add_lanes(u.limbs(), u.size(), done, u.row(0), v.row(0), w.row(0));
+}
+
+
+void
+algo::bigint::batch_mul(const Batch &u, const Batch &v, Batch &w)
+{
+	check_shapes(u, v, w);
+	assert(&w != &u && &w != &v && "Product may not overwrite an operand!");
+
+	for (int j = 0; j < w.limbs(); j++) {
+		std::fill(w.row(j), w.row(j) + w.size(), 0);
+	}
+
+	batch_mul_add(u, v, w);
+}
@@ -0,0 +1,71 @@
+#ifndef ALGO_BIGINT_BATCH_H
+#define ALGO_BIGINT_BATCH_H
+
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "bigint.h"
+
+
+namespace algo::bigint
+{
+	//count unsigned numbers of limbs 32-bit limbs each, stored limb-major:
+	//limb j of every number is contiguous, so one vector instruction works
+	//on the same limb of many numbers and each lane keeps its own carry.
+	//Arithmetic wraps modulo 2^(32 * limbs).
+	class Batch {
+	public:
+		Batch(int limbs, size_t count);
+
+		int
+		limbs() const
+		{
+			return width;
+		}
+
+		size_t
+		size() const
+		{
+			return count;
+		}
+
+		//limb j of every number
+		uint32_t *
+		row(int j)
+		{
+			return repr.data() + j * count;
+		}
+
+		const uint32_t *
+		row(int j) const
+		{
+			return repr.data() + j * count;
+		}
+
+		BigInt get(size_t i) const;
+
+		//value modulo 2^(32 * limbs), so negative numbers wrap to two's
+		//complement like FixedUInt
+		void set(size_t i, const BigInt &value);
+
+	private:
+		int width;
+		size_t count;
+		std::vector<uint32_t> repr;
+	};
+
+
+	//lane by lane w = u + v, u - v, u * v and w + u * v. All three batches
+	//must have the same shape; add and sub may write over an operand, the
+	//products may not. The kernels use AVX-512 or AVX2 when the processor
+	//has them and plain loops otherwise.
+	void batch_add(const Batch &u, const Batch &v, Batch &w);
+	void batch_sub(const Batch &u, const Batch &v, Batch &w);
+	void batch_mul(const Batch &u, const Batch &v, Batch &w);
+	void batch_mul_add(const Batch &u, const Batch &v, Batch &w);
+}
+
+
+#endif
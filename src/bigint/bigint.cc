@@ -1,13 +1,140 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <istream>
+#include <ostream>
 #include <stdexcept>
 #include <cstring>
+#include <utility>
+
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ALGO_BIGINT_X86
+#endif
 
 #include "bigint.h"
+#include "parallel.h"
+#include "../hash/hash.h"
 
 
 #define assert(x) if (!(x)) throw std::invalid_argument(#x)
 
 
-static void
+using algo::bigint::parallel_enabled;
+using algo::bigint::parallel_invoke;
+using algo::bigint::parallel_threads;
+
+
+//with a native 128-bit type the kernels walk the 32-bit limb arrays two
+//limbs at a time, so every carry step and every product covers 64 bits
+#if defined(__SIZEOF_INT128__)
+#define ALGO_BIGINT_WORD64
+typedef unsigned __int128 uint128_t;
+#endif
+
+
+static inline uint64_t
+load_word(const uint32_t *u)
+{
+	return (uint64_t)u[0] | ((uint64_t)u[1] << 32);
+}
+
+
+static inline void
+store_word(uint32_t *u, uint64_t x)
+{
+	u[0] = (uint32_t)x;
+	u[1] = (uint32_t)(x >> 32);
+}
+
+
+#define WORKSPACE_MIN_CHUNK (1 << 16)
+
+
+//per-thread scratch stack the kernels draw temporaries from instead of
+//the call stack; chunks are kept between calls so large temporaries are
+//not faulted in again, and a chunk past the current one is never in use
+struct workspace {
+	std::vector<std::pair<uint32_t *, size_t>> chunks;
+	size_t chunk = 0, used = 0;
+
+	~workspace()
+	{
+		for (auto &c : chunks) {
+			delete[] c.first;
+		}
+	}
+};
+
+
+static workspace &
+thread_workspace()
+{
+	static thread_local workspace ws;
+
+	return ws;
+}
+
+
+//hands back everything taken from the workspace since it was opened
+class scratch_frame {
+public:
+	scratch_frame()
+	: ws(thread_workspace()), chunk(ws.chunk), used(ws.used)
+	{}
+
+	~scratch_frame()
+	{
+		ws.chunk = chunk;
+		ws.used = used;
+	}
+
+	scratch_frame(const scratch_frame &) = delete;
+	scratch_frame &operator=(const scratch_frame &) = delete;
+
+	//n uninitialized limbs valid until the frame closes
+	uint32_t *
+	take(size_t n)
+	{
+		size_t next, size;
+		uint32_t *p;
+
+		if (ws.chunk < ws.chunks.size() && ws.used + n <= ws.chunks[ws.chunk].second) {
+			p = ws.chunks[ws.chunk].first + ws.used;
+			ws.used += n;
+			return p;
+		}
+
+		next = (ws.chunk < ws.chunks.size() && ws.used > 0) ? ws.chunk + 1 : ws.chunk;
+
+		if (next == ws.chunks.size() || ws.chunks[next].second < n) {
+			size = next ? 2 * ws.chunks[next - 1].second : WORKSPACE_MIN_CHUNK;
+			if (size < n) {
+				size = n;
+			}
+
+			if (next == ws.chunks.size()) {
+				ws.chunks.emplace_back(nullptr, 0);
+			}
+			delete[] ws.chunks[next].first;
+			ws.chunks[next] = std::make_pair(new uint32_t[size], size);
+		}
+
+		ws.chunk = next;
+		ws.used = n;
+
+		return ws.chunks[next].first;
+	}
+
+private:
+	workspace &ws;
+	size_t chunk, used;
+};
+
+
+static bool
 algorithm_a(int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
 {
 	bool carry, carry_a, carry_b;
@@ -15,8 +142,19 @@ algorithm_a(int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
 	int j;
 
 	carry = false;
+	j = 0;
 
-	for (j = 0; j < n; j++) {
+#ifdef ALGO_BIGINT_WORD64
+	uint128_t sum;
+
+	for (; j + 1 < n; j += 2) {
+		sum = (uint128_t)load_word(u + j) + load_word(v + j) + carry;
+		store_word(w + j, (uint64_t)sum);
+		carry = (bool)(sum >> 64);
+	}
+#endif
+
+	for (; j < n; j++) {
 		sum_a = u[j] + carry;
 		carry_a = (sum_a < u[j]);
 
@@ -28,10 +166,11 @@ algorithm_a(int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
 		carry = carry_a + carry_b;
 	}
 
-	w[j] = carry;
+	return carry;
 }
 
 
+//lengths decide first, so both operands must be trimmed
 static int
 bigint_cmp(int u_len, const uint32_t *u, int v_len, const uint32_t *v)
 {
@@ -51,18 +190,27 @@ bigint_cmp(int u_len, const uint32_t *u, int v_len, const uint32_t *v)
 }
 
 
-static void
+static bool
 algorithm_s(int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
 {
 	bool borrow, borrow_a, borrow_b;
 	uint32_t diff_a, diff_b;
 	int j;
 
-	assert(bigint_cmp(n, u, n, v) >= 0 && "Subtraction result would be negative!");
-
 	borrow = false;
+	j = 0;
 
-	for (j = 0; j < n; j++) {
+#ifdef ALGO_BIGINT_WORD64
+	uint128_t diff;
+
+	for (; j + 1 < n; j += 2) {
+		diff = (uint128_t)load_word(u + j) - load_word(v + j) - borrow;
+		store_word(w + j, (uint64_t)diff);
+		borrow = (bool)(diff >> 64);
+	}
+#endif
+
+	for (; j < n; j++) {
 		diff_a = u[j] - borrow;
 		borrow_a = (diff_a > u[j]);
 
@@ -74,7 +222,7 @@ algorithm_s(int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
 		borrow = borrow_a + borrow_b;
 	}
 
-	assert(!borrow && "Nothing to borrow from!");
+	return borrow;
 }
 
 
@@ -90,6 +238,77 @@ mul_32_by_32(uint32_t x, uint32_t y, uint32_t *z_hi, uint32_t *z_lo)
 }
 
 
+static void
+carry_into(int n, uint32_t *w, uint32_t k)
+{
+	int i;
+
+	for (i = 0; k; i++) {
+		assert(i < n && "Leftover carry!");
+		w[i] += k;
+		k = (w[i] < k);
+	}
+}
+
+
+static uint32_t
+addmul_1(int n, const uint32_t *u, uint32_t x, uint32_t *w)
+{
+	uint64_t k;
+	int i;
+
+	k = 0;
+	for (i = 0; i < n; i++) {
+		k += (uint64_t)u[i] * x + w[i];
+		w[i] = (uint32_t)k;
+		k >>= 32;
+	}
+
+	return (uint32_t)k;
+}
+
+
+#ifdef ALGO_BIGINT_WORD64
+static void
+algorithm_m_words(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	int m0 = m & ~1, n0 = n & ~1;
+	int i, j;
+	uint64_t k, x;
+	uint128_t prod;
+
+	for (i = 0; i < m0; i++) {
+		w[i] = 0;
+	}
+
+	for (j = 0; j < n0; j += 2) {
+		x = load_word(v + j);
+
+		k = 0;
+		for (i = 0; i < m0; i += 2) {
+			prod = (uint128_t)load_word(u + i) * x + load_word(w + i + j) + k;
+			store_word(w + i + j, (uint64_t)prod);
+			k = (uint64_t)(prod >> 64);
+		}
+
+		store_word(w + j + m0, k);
+	}
+
+	for (i = m0 + n0; i < m + n; i++) {
+		w[i] = 0;
+	}
+
+	//an odd top limb on either side is folded in with a single row
+	if (m0 != m) {
+		carry_into(1, w + m + n - 1, addmul_1(n, v, u[m - 1], w + m - 1));
+	}
+	if (n0 != n) {
+		carry_into(m + 1 - m0, w + n0 + m0, addmul_1(m0, u, v[n - 1], w + n - 1));
+	}
+}
+#endif
+
+
 static void
 algorithm_m(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
 {
@@ -97,6 +316,13 @@ algorithm_m(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
 	uint32_t k, hi_prod, lo_prod;
 	bool carry_a, carry_b;
 
+#ifdef ALGO_BIGINT_WORD64
+	if (m >= 2 && n >= 2) {
+		algorithm_m_words(m, n, u, v, w);
+		return;
+	}
+#endif
+
 	for (i = 0; i < m; i++) {
 		w[i] = 0;
 	}
@@ -126,264 +352,1477 @@ algorithm_m(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
 }
 
 
+#ifdef ALGO_BIGINT_WORD64
+//w[0..2n-1] = u^2 for even n over 64-bit words, the same doubling scheme
+//as algorithm_m_square
 static void
-div_32_by_16(uint16_t u_hi, uint16_t u_lo, uint16_t v, uint16_t *q, uint16_t *r)
+algorithm_m_square_words(int n, const uint32_t *u, uint32_t *w)
 {
-	uint32_t u = ((uint32_t)u_hi << 16) | u_lo;
-
-	assert(v > 0 && "Division by zero!");
-	assert(u / v <= UINT16_MAX && "Division overflow!");
-
-	*q = (uint16_t)(u / v);
-	*r = (uint16_t)(u % v);
-}
+	int i, j;
+	uint64_t k, x;
+	uint128_t prod, t;
 
+	for (i = 0; i < 2 * n; i++) {
+		w[i] = 0;
+	}
 
-static void
-short_division(int n, uint16_t *u, uint16_t v, uint16_t *q, uint16_t *r)
-{
-	uint16_t k;
-	int i;
+	for (i = 0; i < n; i += 2) {
+		x = load_word(u + i);
 
-	assert(v > 0 && "Division by zero!");
-	assert(n > 0 && "Dividing empty number!");
+		k = 0;
+		for (j = i + 2; j < n; j += 2) {
+			prod = (uint128_t)load_word(u + j) * x + load_word(w + i + j) + k;
+			store_word(w + i + j, (uint64_t)prod);
+			k = (uint64_t)(prod >> 64);
+		}
 
-	k = 0;
-	for (i = n - 1; i >= 0; i--) {
-		div_32_by_16(k, u[i], v, &q[i], &k);
+		store_word(w + i + n, k);
 	}
-	*r = k;
-}
-
 
-static int
-leading_zeros(uint16_t x)
-{
-	int n;
+	k = 0;
+	for (i = 0; i < n; i += 2) {
+		x = load_word(u + i);
+		prod = (uint128_t)x * x;
 
-	assert(x != 0);
+		t = 2 * (uint128_t)load_word(w + 2 * i) + (uint64_t)prod + k;
+		store_word(w + 2 * i, (uint64_t)t);
+		k = (uint64_t)(t >> 64);
 
-	n = 0;
-	while (x <= UINT16_MAX / 2) {
-		x <<= 1;
-		n++;
+		t = 2 * (uint128_t)load_word(w + 2 * i + 2) + (uint64_t)(prod >> 64) + k;
+		store_word(w + 2 * i + 2, (uint64_t)t);
+		k = (uint64_t)(t >> 64);
 	}
-
-	return n;
 }
+#endif
 
 
+//w[0..2n-1] = u^2 with each cross product u[i] * u[j], i < j, computed
+//once: the rows above the diagonal are summed, doubled, and the squares
+//u[i]^2 added in the same carry pass
 static void
-shift_left(int n, uint16_t *u, int m)
+algorithm_m_square(int n, const uint32_t *u, uint32_t *w)
 {
-	uint16_t k, t;
 	int i;
+	uint64_t t, sq;
+	uint32_t k;
+
+#ifdef ALGO_BIGINT_WORD64
+	//an odd top limb t adds 2 * t * u' * B^(n - 1) + t^2 * B^(2n - 2)
+	if (n >= 2) {
+		algorithm_m_square_words(n & ~1, u, w);
+
+		if (n & 1) {
+			w[2 * n - 2] = 0;
+			w[2 * n - 1] = 0;
+			for (i = 0; i < 2; i++) {
+				carry_into(2, w + 2 * n - 2, addmul_1(n - 1, u, u[n - 1], w + n - 1));
+			}
 
-	assert(m > 0);
-	assert(m < 16);
+			t = load_word(w + 2 * n - 2) + (uint64_t)u[n - 1] * u[n - 1];
+			store_word(w + 2 * n - 2, t);
+		}
+		return;
+	}
+#endif
+
+	for (i = 0; i < 2 * n; i++) {
+		w[i] = 0;
+	}
 
-	k = 0;
 	for (i = 0; i < n; i++) {
-		t = u[i] >> (16 - m);
-		u[i] = (u[i] << m) | k;
-		k = t;
+		w[i + n] = addmul_1(n - i - 1, u + i + 1, u[i], w + 2 * i + 1);
 	}
 
-	assert(k == 0 && "Leftover carry!");
+	k = 0;
+	for (i = 0; i < n; i++) {
+		sq = (uint64_t)u[i] * u[i];
+
+		t = 2 * (uint64_t)w[2 * i] + (uint32_t)sq + k;
+		w[2 * i] = (uint32_t)t;
+		k = (uint32_t)(t >> 32);
+
+		t = 2 * (uint64_t)w[2 * i + 1] + (sq >> 32) + k;
+		w[2 * i + 1] = (uint32_t)t;
+		k = (uint32_t)(t >> 32);
+	}
 }
 
 
-static void
-shift_right(int n, uint16_t *u, int m)
+#ifdef ALGO_BIGINT_WORD64
+//w[0..m-1] += u * x over 64-bit words for even m, returning the carry word
+static uint64_t
+addmul_1_words(int m, const uint32_t *u, uint64_t x, uint32_t *w)
 {
-	uint16_t k, t;
+	uint128_t prod;
+	uint64_t k;
 	int i;
 
-	assert(m > 0);
-	assert(m < 16);
-
 	k = 0;
-	for (i = n - 1; i >= 0; i--) {
-		t = u[i] << (16 - m);
-		u[i] = (u[i] >> m) | k;
-		k = t;
+	for (i = 0; i < m; i += 2) {
+		prod = (uint128_t)load_word(u + i) * x + load_word(w + i) + k;
+		store_word(w + i, (uint64_t)prod);
+		k = (uint64_t)(prod >> 64);
 	}
 
-	assert(k == 0 && "Leftover carry!");
+	return k;
 }
+#endif
 
 
+//w += u * v over w_len limbs, enough for the sum, with m >= n: algorithm_m's
+//rows accumulated in place of a zeroed product, each row's carry rippling up
 static void
-algorithm_d(int m, int n, uint16_t *u, uint16_t *v, uint16_t *q)
+algorithm_m_accumulate(int w_len, uint32_t *w, int m, int n, const uint32_t *u, const uint32_t *v)
 {
-	int shift;
-	int j, i;
-	uint32_t qhat, rhat, p, t;
-	uint16_t k, k2, d;
+	int j, n0 = 0;
 
-	assert(n > 0 && "v must be greater than zero!");
-	assert(v[n - 1] != 0 && "v must not have leading zeros!");
+#ifdef ALGO_BIGINT_WORD64
+	int m0 = m & ~1;
+	uint64_t k;
 
-	if (n == 1) {
-		short_division(m + n, u, v[0], q, &u[0]);
-		return;
+	n0 = n & ~1;
+	for (j = 0; j < n0; j += 2) {
+		k = addmul_1_words(m0, u, load_word(v + j), w + j);
+		carry_into(w_len - j - m0, w + j + m0, (uint32_t)k);
+		carry_into(w_len - j - m0 - 1, w + j + m0 + 1, (uint32_t)(k >> 32));
 	}
 
-	u[m + n] = 0;
-	shift = leading_zeros(v[n-1]);
-	if (shift) {
-			shift_left(n, v, shift);
-			shift_left(m + n + 1, u, shift);
+	//an odd top limb of u meets the word rows as one column
+	if (m0 != m && n0 > 0) {
+		carry_into(w_len - m + 1 - n0, w + m - 1 + n0, addmul_1(n0, v, u[m - 1], w + m - 1));
 	}
+#endif
 
-	for (j = m; j >= 0; j--) {
-		t = ((uint32_t)u[j + n] << 16) | u[j + n - 1];
-		qhat = t / v[n - 1];
-		rhat = t % v[n - 1];
+	for (j = n0; j < n; j++) {
+		carry_into(w_len - j - m, w + j + m, addmul_1(m, u, v[j], w + j));
+	}
+}
 
-		while (true) {
-			assert(n >= 2);
-			if (qhat > UINT16_MAX || qhat * v[n - 2] > ((rhat << 16) | u[j + n - 2])) {
-				qhat--;
-				rhat += v[n - 1];
-				if (rhat <= UINT16_MAX) {
-					continue;
-				}
-			}
-			break;
-		}
+#define KARATSUBA_THRESHOLD 48
+#define TOOM3_THRESHOLD 240
+#define NTT_THRESHOLD 1500
 
-		k = 0;
-		for (i = 0; i <= n; i++) {
-			p = qhat * (i == n ? 0 : v[i]);
-			k2 = (p >> 16);
+//squares between these sizes use algorithm_m_square; below, its extra
+//pass costs more than the halved products save
+#define SQUARE_THRESHOLD 12
+#define SQUARE_KARATSUBA_THRESHOLD 128
 
-			d = u[j + i] - (uint16_t)p;
-			k2 += (d > u[j + i]);
+//three NTT-friendly primes whose product exceeds 2^90, enough to hold
+//every coefficient of a 32-bit limb convolution up to 2^26 points
+#define NTT_PRIME_1 2013265921U
+#define NTT_PRIME_2 1811939329U
+#define NTT_PRIME_3 469762049U
+#define NTT_ROOT_1 31U
+#define NTT_ROOT_2 13U
+#define NTT_ROOT_3 3U
+#define NTT_MAX_LENGTH (1 << 26)
 
-			u[j + i] = d - k;
-			k2 += (u[j + i] > d);
 
-			k = k2;
-		}
+static void multiply(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *w);
 
-		q[j] = qhat;
-		if (k != 0) {
-			q[j]--;
-			k = 0;
-			for (i = 0; i < n; i++) {
-				t = u[j + i] + v[i] + k;
-				u[j + i] = (uint16_t)t;
-				k = t >> 16;
-			}
-			u[j + n] += k;
-		}
-	}
 
-	if (shift) {
-		shift_right(n, u, shift);
+static int
+trimmed_length(int n, const uint32_t *u)
+{
+	while (n > 0 && u[n - 1] == 0) {
+		n--;
 	}
+
+	return n;
 }
 
 
 static void
-u32_to_u16(int n, const uint32_t *u32, uint16_t *u16)
+add_into(int w_len, uint32_t *w, int t_len, const uint32_t *t)
 {
+	bool carry;
 	int i;
 
-	for (i = 0; i < n; i++) {
-		u16[i * 2 + 0] = (uint16_t)u32[i];
-		u16[i * 2 + 1] = (uint16_t)(u32[i] >> 16);
+	t_len = trimmed_length(t_len, t);
+	assert(t_len <= w_len && "Addend does not fit!");
+
+	carry = algorithm_a(t_len, w, t, w);
+
+	for (i = t_len; carry && i < w_len; i++) {
+		w[i]++;
+		carry = (w[i] == 0);
 	}
+
+	assert(!carry && "Leftover carry!");
 }
 
 
 static void
-u16_to_u32(int n, const uint16_t *u16, uint32_t *u32)
+sub_from(int w_len, uint32_t *w, int t_len, const uint32_t *t)
 {
+	bool borrow;
 	int i;
 
-	assert((n % 2) == 0 && "Expected n to be even!");
+	t_len = trimmed_length(t_len, t);
+	assert(t_len <= w_len && "Subtrahend does not fit!");
 
-	for (i = 0; i < n; i += 2) {
-		u32[i / 2] = u16[i] | ((uint32_t)u16[i + 1] << 16);
+	borrow = algorithm_s(t_len, w, t, w);
+
+	for (i = t_len; borrow && i < w_len; i++) {
+		borrow = (w[i] == 0);
+		w[i]--;
 	}
+
+	assert(!borrow && "Nothing to borrow from!");
 }
 
 
 static void
-algorithm_d_wrapper(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *q, uint32_t *r)
+multiply_unbalanced(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
 {
-	uint16_t u16[(m + n) * 2 + 1];
-	uint16_t v16[n * 2];
-	uint16_t q16[(m + 1) * 2];
-
-	assert(n > 0 && "Division by zero!");
-	assert(v[n - 1] != 0 && "v has leading zero!");
-
-	u32_to_u16(m + n, u, u16);
-	u32_to_u16(n, v, v16);
-
-	bool v_zero = (v16[n * 2 - 1] == 0);
+	scratch_frame frame;
+	uint32_t *t = frame.take(2 * n);
+	int i, len;
 
-	algorithm_d(m * 2 + v_zero, n * 2 - v_zero, u16, v16, q16);
+	assert(m >= n);
 
-	if (v_zero)
-		u16[n * 2 - 1] = 0;
-	else
-		q16[(m + 1) * 2 - 1] = 0;
+	for (i = 0; i < m + n; i++) {
+		w[i] = 0;
+	}
 
-	u16_to_u32((m + 1) * 2, q16, q);
-	u16_to_u32(n * 2, u16, r);
+	for (i = 0; i < m; i += n) {
+		len = (m - i < n) ? m - i : n;
+		multiply(len, n, u + i, v, t);
+		add_into(m + n - i, w + i, len + n, t);
+	}
 }
 
 
 static void
-multiply_add(uint32_t *u, int *m, uint32_t x, uint32_t y)
+karatsuba(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
 {
+	int h = (m + 1) / 2;
+	scratch_frame frame;
+	bool square = (u == v && m == n);
+	uint32_t *su = frame.take(h + 1);
+	uint32_t *sv = square ? su : frame.take(h + 1);
+	uint32_t *z1 = frame.take(2 * h + 2);
 	int i;
-	uint32_t k, hi_prod, lo_prod;
 
-	k = y;
+	assert(m >= n && n > h);
 
-	for (i = 0; i < *m; i++) {
-		mul_32_by_32(u[i], x, &hi_prod, &lo_prod);
-		lo_prod += k;
-		k = hi_prod + (lo_prod < k);
-		u[i] = lo_prod;
+	//a square needs one sum, and all three products are squares again
+	for (i = 0; i < h; i++) {
+		su[i] = u[i];
+		sv[i] = v[i];
+	}
+	su[h] = 0;
+	sv[h] = 0;
+	add_into(h + 1, su, m - h, u + h);
+	if (!square) {
+		add_into(h + 1, sv, n - h, v + h);
 	}
 
-	if (k) {
-		u[*m] = k;
-		(*m)++;
+	//the three products write disjoint buffers
+	if (parallel_enabled(n)) {
+		std::function<void()> tasks[] = {
+			[&] { multiply(h, h, u, v, w); },
+			[&] { multiply(m - h, n - h, u + h, v + h, w + 2 * h); },
+			[&] { multiply(h + 1, h + 1, su, sv, z1); },
+		};
+		parallel_invoke(tasks, 3);
+	} else {
+		multiply(h, h, u, v, w);
+		multiply(m - h, n - h, u + h, v + h, w + 2 * h);
+		multiply(h + 1, h + 1, su, sv, z1);
 	}
+
+	sub_from(2 * h + 2, z1, 2 * h, w);
+	sub_from(2 * h + 2, z1, m + n - 2 * h, w + 2 * h);
+	add_into(m + n - h, w + h, 2 * h + 2, z1);
 }
 
 
-static void
-bigint_from_string(int n, const char *str, int *u_len, uint32_t *u)
-{
-	uint32_t chunk;
-	int i;
+//a signed Toom-3 value: the magnitude is trimmed and is either a piece of
+//an operand or limbs drawn from the scratch frame of the toom3 call, with
+//the sign kept beside it
+struct toom_num {
+	const uint32_t *mag;
+	int len;
+	bool neg;
+};
 
-	static const uint32_t pow10s[] = {
-		1000000000,
-		10,
-		100,
-		1000,
-		10000,
-		100000,
-		1000000,
-		10000000,
-		100000000
-	};
 
-	*u_len = 0;
-	chunk = 0;
+static toom_num
+toom_piece(int len, const uint32_t *u, int from, int k)
+{
+	toom_num x;
 
-	for (i = 1; i <= n; i++) {
-		assert(*str >= '0' && *str <= '9');
-		chunk = chunk * 10 + *str++ - '0';
+	x.mag = u;
+	x.len = 0;
+	if (from < len) {
+		x.mag = u + from;
+		x.len = trimmed_length(from + k < len ? k : len - from, x.mag);
+	}
+	x.neg = false;
+
+	return x;
+}
+
+
+static toom_num
+toom_add(const toom_num &x, const toom_num &y, bool negate_y, scratch_frame &frame)
+{
+	const toom_num *a = &x, *b = &y;
+	bool b_neg = y.neg ^ negate_y;
+	uint32_t *w;
+	toom_num r;
+
+	if (a->len < b->len) {
+		std::swap(a, b);
+	}
+	w = frame.take(a->len + 1);
+	r.mag = w;
+
+	if (x.neg == b_neg) {
+		std::copy(a->mag, a->mag + a->len, w);
+		w[a->len] = 0;
+		add_into(a->len + 1, w, b->len, b->mag);
+		r.len = trimmed_length(a->len + 1, w);
+		r.neg = x.neg;
+		return r;
+	}
+
+	//the operands were ordered by length, so compare to order them by size
+	if (bigint_cmp(a->len, a->mag, b->len, b->mag) < 0) {
+		std::swap(a, b);
+	}
+	std::copy(a->mag, a->mag + a->len, w);
+	sub_from(a->len, w, b->len, b->mag);
+	r.len = trimmed_length(a->len, w);
+	r.neg = (a == &x) ? x.neg : b_neg;
+
+	return r;
+}
+
+
+static toom_num
+toom_shift(const toom_num &x, int bits, scratch_frame &frame)
+{
+	uint32_t *w = frame.take(x.len + 1);
+	toom_num r;
+	uint32_t k;
+	int i;
+
+	assert(bits > 0 && bits < 32);
+
+	k = 0;
+	for (i = 0; i < x.len; i++) {
+		w[i] = (x.mag[i] << bits) | k;
+		k = x.mag[i] >> (32 - bits);
+	}
+	w[i] = k;
+
+	r.mag = w;
+	r.len = trimmed_length(x.len + 1, w);
+	r.neg = x.neg;
+
+	return r;
+}
+
+
+static toom_num
+toom_exact_div(const toom_num &x, uint32_t d, scratch_frame &frame)
+{
+	uint32_t *w = frame.take(x.len);
+	toom_num r;
+	uint64_t q;
+	int i;
+
+	q = 0;
+	for (i = x.len - 1; i >= 0; i--) {
+		q = (q << 32) | x.mag[i];
+		w[i] = (uint32_t)(q / d);
+		q %= d;
+	}
+	assert(q == 0 && "Inexact division!");
+
+	r.mag = w;
+	r.len = trimmed_length(x.len, w);
+	r.neg = x.neg;
+
+	return r;
+}
+
+
+//x * y into w, which has room for x.len + y.len limbs. The products run
+//on the pool's threads, so w is taken beforehand and not from a frame of
+//their own.
+static toom_num
+toom_mul(const toom_num &x, const toom_num &y, uint32_t *w)
+{
+	toom_num r;
+
+	r.mag = w;
+	r.len = 0;
+	if (x.len > 0 && y.len > 0) {
+		multiply(x.len, y.len, x.mag, y.mag, w);
+		r.len = trimmed_length(x.len + y.len, w);
+	}
+	r.neg = x.neg ^ y.neg;
+
+	return r;
+}
+
+
+//the pieces are read in place, and the points, the products and the
+//interpolation all draw from one scratch frame
+static void
+toom3(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	int k = (m + 2) / 3;
+	scratch_frame frame;
+	int i;
+
+	toom_num u0 = toom_piece(m, u, 0, k);
+	toom_num u1 = toom_piece(m, u, k, k);
+	toom_num u2 = toom_piece(m, u, 2 * k, k);
+	toom_num v0 = toom_piece(n, v, 0, k);
+	toom_num v1 = toom_piece(n, v, k, k);
+	toom_num v2 = toom_piece(n, v, 2 * k, k);
+
+	//evaluate at 0, 1, -1, -2 and infinity
+	toom_num pt = toom_add(u0, u2, false, frame);
+	toom_num p1 = toom_add(pt, u1, false, frame);
+	toom_num pm1 = toom_add(pt, u1, true, frame);
+	toom_num pm2 = toom_add(toom_shift(toom_add(pm1, u2, false, frame), 1, frame), u0, true, frame);
+
+	//for a square the second set of points is the first, and every
+	//pointwise product reaches multiply with both operands aliased
+	bool square = (u == v && m == n);
+	toom_num qt, q1, qm1, qm2;
+
+	if (!square) {
+		qt = toom_add(v0, v2, false, frame);
+		q1 = toom_add(qt, v1, false, frame);
+		qm1 = toom_add(qt, v1, true, frame);
+		qm2 = toom_add(toom_shift(toom_add(qm1, v2, false, frame), 1, frame), v0, true, frame);
+	}
+
+	const toom_num &a0 = square ? u0 : v0, &a1 = square ? p1 : q1, &am1 = square ? pm1 : qm1;
+	const toom_num &am2 = square ? pm2 : qm2, &a2 = square ? u2 : v2;
+
+	uint32_t *w0 = frame.take(u0.len + a0.len), *w1 = frame.take(p1.len + a1.len);
+	uint32_t *wm1 = frame.take(pm1.len + am1.len), *wm2 = frame.take(pm2.len + am2.len);
+	uint32_t *winf = frame.take(u2.len + a2.len);
+	toom_num r0, r1, rm1, rm2, rinf;
+	std::function<void()> tasks[] = {
+		[&] { r0 = toom_mul(u0, a0, w0); },
+		[&] { r1 = toom_mul(p1, a1, w1); },
+		[&] { rm1 = toom_mul(pm1, am1, wm1); },
+		[&] { rm2 = toom_mul(pm2, am2, wm2); },
+		[&] { rinf = toom_mul(u2, a2, winf); },
+	};
+
+	if (parallel_enabled(n)) {
+		parallel_invoke(tasks, 5);
+	} else {
+		for (auto &task : tasks) {
+			task();
+		}
+	}
+
+	//interpolate following Bodrato's sequence
+	toom_num r3 = toom_exact_div(toom_add(rm2, r1, true, frame), 3, frame);
+	r1 = toom_exact_div(toom_add(r1, rm1, true, frame), 2, frame);
+	toom_num r2 = toom_add(rm1, r0, true, frame);
+	r3 = toom_add(toom_exact_div(toom_add(r2, r3, true, frame), 2, frame), toom_shift(rinf, 1, frame), false, frame);
+	r2 = toom_add(toom_add(r2, r1, false, frame), rinf, true, frame);
+	r1 = toom_add(r1, r3, true, frame);
+
+	for (i = 0; i < m + n; i++) {
+		w[i] = 0;
+	}
+
+	const toom_num *coeffs[] = { &r0, &r1, &r2, &r3, &rinf };
+
+	for (i = 0; i < 5 && i * k < m + n; i++) {
+		const toom_num &c = *coeffs[i];
+		assert((!c.neg || c.len == 0) && "Negative coefficient!");
+		add_into(m + n - i * k, w + i * k, c.len, c.mag);
+	}
+}
+
+
+static uint32_t
+pow_mod(uint32_t b, uint64_t e, uint32_t p)
+{
+	uint64_t r = 1, x = b;
+
+	while (e) {
+		if (e & 1) {
+			r = r * x % p;
+		}
+		x = x * x % p;
+		e >>= 1;
+	}
+
+	return (uint32_t)r;
+}
+
+
+//butterflies from, ..., to - 1 of the pass over blocks of len, numbered
+//block by block, so disjoint ranges can run on separate threads
+template <uint32_t P>
+static void
+ntt_butterflies(uint32_t *a, const uint32_t *roots, int len, int from, int to)
+{
+	int half = len / 2;
+	int i = from / half * len, k = from % half;
+	uint32_t u, v;
+
+	for (int b = from; b < to; b++) {
+		u = a[i + k];
+		v = (uint64_t)a[i + k + half] * roots[k] % P;
+		a[i + k] = (u + v >= P) ? u + v - P : u + v;
+		a[i + k + half] = (u >= v) ? u - v : u + P - v;
+
+		if (++k == half) {
+			k = 0;
+			i += len;
+		}
+	}
+}
+
+
+template <uint32_t P, uint32_t G>
+static void
+ntt(int n, uint32_t *a, bool invert)
+{
+	scratch_frame frame;
+	uint32_t *roots = frame.take(n / 2);
+	std::vector<std::function<void()>> tasks;
+	uint32_t u, v, w;
+	int i, j, k, len, chunks;
+
+	for (i = 1, j = 0; i < n; i++) {
+		k = n >> 1;
+		for (; j & k; k >>= 1) {
+			j ^= k;
+		}
+		j ^= k;
+
+		if (i < j) {
+			std::swap(a[i], a[j]);
+		}
+	}
+
+	for (len = 2; len <= n; len <<= 1) {
+		w = pow_mod(G, (P - 1) / len, P);
+		if (invert) {
+			w = pow_mod(w, P - 2, P);
+		}
+
+		roots[0] = 1;
+		for (k = 1; k < len / 2; k++) {
+			roots[k] = (uint64_t)roots[k - 1] * w % P;
+		}
+
+		if (parallel_enabled(n)) {
+			chunks = parallel_threads();
+			tasks.clear();
+			for (i = 0; i < chunks; i++) {
+				j = (int64_t)n / 2 * i / chunks;
+				k = (int64_t)n / 2 * (i + 1) / chunks;
+				tasks.push_back([=] { ntt_butterflies<P>(a, roots, len, j, k); });
+			}
+			parallel_invoke(tasks.data(), chunks);
+			continue;
+		}
+
+		for (i = 0; i < n; i += len) {
+			for (k = 0; k < len / 2; k++) {
+				u = a[i + k];
+				v = (uint64_t)a[i + k + len / 2] * roots[k] % P;
+				a[i + k] = (u + v >= P) ? u + v - P : u + v;
+				a[i + k + len / 2] = (u >= v) ? u - v : u + P - v;
+			}
+		}
+	}
+
+	if (invert) {
+		w = pow_mod(n, P - 2, P);
+		for (i = 0; i < n; i++) {
+			a[i] = (uint64_t)a[i] * w % P;
+		}
+	}
+}
+
+
+template <uint32_t P, uint32_t G>
+static void
+ntt_convolve(int m, int n, const uint32_t *u, const uint32_t *v, int size, uint32_t *c)
+{
+	bool square = (u == v && m == n);
+	scratch_frame frame;
+	uint32_t *t = square ? c : frame.take(size);
+	int i;
+
+	//a square transforms once and multiplies the spectrum by itself
+	for (i = 0; i < size; i++) {
+		c[i] = (i < m) ? u[i] % P : 0;
+		t[i] = (i < n) ? v[i] % P : 0;
+	}
+
+	if (square) {
+		ntt<P, G>(size, c, false);
+	} else if (parallel_enabled(size)) {
+		std::function<void()> tasks[] = {
+			[&] { ntt<P, G>(size, c, false); },
+			[&] { ntt<P, G>(size, t, false); },
+		};
+		parallel_invoke(tasks, 2);
+	} else {
+		ntt<P, G>(size, c, false);
+		ntt<P, G>(size, t, false);
+	}
+
+	for (i = 0; i < size; i++) {
+		c[i] = (uint64_t)c[i] * t[i] % P;
+	}
+
+	ntt<P, G>(size, c, true);
+}
+
+
+static void
+ntt_multiply(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	static const uint32_t p1 = NTT_PRIME_1, p2 = NTT_PRIME_2, p3 = NTT_PRIME_3;
+
+	uint64_t p1_inv = pow_mod(p1, p2 - 2, p2);
+	uint64_t p12_inv = pow_mod((uint64_t)p1 * p2 % p3, p3 - 2, p3);
+	scratch_frame frame;
+	uint32_t *c1, *c2, *c3;
+	unsigned __int128 k;
+	uint64_t t2, t3, x12;
+	int size, i;
+
+	assert(m + n <= NTT_MAX_LENGTH && "Operands too large for the transform!");
+
+	for (size = 1; size < m + n; size <<= 1);
+
+	c1 = frame.take(size);
+	c2 = frame.take(size);
+	c3 = frame.take(size);
+
+	//one independent transform per prime
+	if (parallel_enabled(n)) {
+		std::function<void()> tasks[] = {
+			[&] { ntt_convolve<NTT_PRIME_1, NTT_ROOT_1>(m, n, u, v, size, c1); },
+			[&] { ntt_convolve<NTT_PRIME_2, NTT_ROOT_2>(m, n, u, v, size, c2); },
+			[&] { ntt_convolve<NTT_PRIME_3, NTT_ROOT_3>(m, n, u, v, size, c3); },
+		};
+		parallel_invoke(tasks, 3);
+	} else {
+		ntt_convolve<NTT_PRIME_1, NTT_ROOT_1>(m, n, u, v, size, c1);
+		ntt_convolve<NTT_PRIME_2, NTT_ROOT_2>(m, n, u, v, size, c2);
+		ntt_convolve<NTT_PRIME_3, NTT_ROOT_3>(m, n, u, v, size, c3);
+	}
+
+	//recombine the residues with Garner's algorithm and propagate carries
+	k = 0;
+	for (i = 0; i < m + n; i++) {
+		t2 = (c2[i] + p2 - c1[i] % p2) % p2 * p1_inv % p2;
+		x12 = c1[i] + t2 * p1;
+		t3 = (c3[i] + p3 - x12 % p3) % p3 * p12_inv % p3;
+
+		k += (unsigned __int128)t3 * p1 * p2 + x12;
+		w[i] = (uint32_t)k;
+		k >>= 32;
+	}
+
+	assert(k == 0 && "Leftover carry!");
+}
+
+
+static void
+multiply(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *w)
+{
+	if (m < n) {
+		std::swap(m, n);
+		std::swap(u, v);
+	}
+
+	if (u == v && m == n && n >= SQUARE_THRESHOLD && n < SQUARE_KARATSUBA_THRESHOLD) {
+		algorithm_m_square(n, u, w);
+	} else if (n < KARATSUBA_THRESHOLD) {
+		algorithm_m(m, n, u, v, w);
+	} else if (2 * n <= m + 1) {
+		multiply_unbalanced(m, n, u, v, w);
+	} else if (n < TOOM3_THRESHOLD) {
+		karatsuba(m, n, u, v, w);
+	} else if (n >= NTT_THRESHOLD && m + n <= NTT_MAX_LENGTH) {
+		ntt_multiply(m, n, u, v, w);
+	} else {
+		toom3(m, n, u, v, w);
+	}
+}
+
+
+static void
+div_64_by_32(uint32_t u_hi, uint32_t u_lo, uint32_t v, uint32_t *q, uint32_t *r)
+{
+	uint64_t u = ((uint64_t)u_hi << 32) | u_lo;
+
+	assert(v > 0 && "Division by zero!");
+	assert(u / v <= UINT32_MAX && "Division overflow!");
+
+	*q = (uint32_t)(u / v);
+	*r = (uint32_t)(u % v);
+}
+
+
+static void
+short_division(int n, const uint32_t *u, uint32_t v, uint32_t *q, uint32_t *r)
+{
+	uint32_t k;
+	int i;
+
+	assert(v > 0 && "Division by zero!");
+	assert(n > 0 && "Dividing empty number!");
+
+	k = 0;
+	for (i = n - 1; i >= 0; i--) {
+		div_64_by_32(k, u[i], v, &q[i], &k);
+	}
+	*r = k;
+}
+
+
+static int
+leading_zeros(uint32_t x)
+{
+	int n;
+
+	assert(x != 0);
+
+	n = 0;
+	while (x <= UINT32_MAX / 2) {
+		x <<= 1;
+		n++;
+	}
+
+	return n;
+}
+
+
+static void
+shift_left(int n, uint32_t *u, int m)
+{
+	uint32_t k, t;
+	int i;
+
+	assert(m > 0);
+	assert(m < 32);
+
+	k = 0;
+	for (i = 0; i < n; i++) {
+		t = u[i] >> (32 - m);
+		u[i] = (u[i] << m) | k;
+		k = t;
+	}
+
+	assert(k == 0 && "Leftover carry!");
+}
+
+
+static void
+shift_right(int n, uint32_t *u, int m)
+{
+	uint32_t k, t;
+	int i;
+
+	assert(m > 0);
+	assert(m < 32);
+
+	k = 0;
+	for (i = n - 1; i >= 0; i--) {
+		t = u[i] << (32 - m);
+		u[i] = (u[i] >> m) | k;
+		k = t;
+	}
+
+	assert(k == 0 && "Leftover carry!");
+}
+
+
+//word-parallel kernels for the bitwise operators and the shifts: each
+//output limb reads input limbs at fixed offsets and carries nothing. A
+//vector kernel covers whole vectors from the start of the loop it stands
+//in for and returns how many limbs that was; the scalar loops finish.
+struct word_kernels {
+	int (*bitwise)(int n, uint32_t *a, const uint32_t *b, char op);
+	int (*shift_left)(int n, const uint32_t *u, int m, uint32_t *w);
+	int (*shift_right)(int n, const uint32_t *u, int m, uint32_t *w);
+};
+
+
+static int
+no_bitwise(int n, uint32_t *a, const uint32_t *b, char op)
+{
+	return 0;
+}
+
+
+static int
+no_shift(int n, const uint32_t *u, int m, uint32_t *w)
+{
+	return 0;
+}
+
+
+#ifdef ALGO_BIGINT_X86
+
+__attribute__((target("avx2")))
+static int
+bitwise_avx2(int n, uint32_t *a, const uint32_t *b, char op)
+{
+	const __m256i ones = _mm256_set1_epi32(-1);
+	__m256i x, y;
+	int i;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		x = _mm256_loadu_si256((const __m256i *)(a + i));
+		y = (op == '~') ? ones : _mm256_loadu_si256((const __m256i *)(b + i));
+
+		switch (op) {
+		case '&':
+			x = _mm256_and_si256(x, y);
+			break;
+		case '|':
+			x = _mm256_or_si256(x, y);
+			break;
+		default:
+			x = _mm256_xor_si256(x, y);
+			break;
+		}
+
+		_mm256_storeu_si256((__m256i *)(a + i), x);
+	}
+
+	return i;
+}
+
+
+__attribute__((target("avx2")))
+static int
+shift_left_avx2(int n, const uint32_t *u, int m, uint32_t *w)
+{
+	const __m128i left = _mm_cvtsi32_si128(m), right = _mm_cvtsi32_si128(32 - m);
+	__m256i hi, lo;
+	int i;
+
+	for (i = 1; i + 8 <= n; i += 8) {
+		hi = _mm256_loadu_si256((const __m256i *)(u + i));
+		lo = _mm256_loadu_si256((const __m256i *)(u + i - 1));
+		_mm256_storeu_si256((__m256i *)(w + i),
+			_mm256_or_si256(_mm256_sll_epi32(hi, left), _mm256_srl_epi32(lo, right)));
+	}
+
+	return i - 1;
+}
+
+
+__attribute__((target("avx2")))
+static int
+shift_right_avx2(int n, const uint32_t *u, int m, uint32_t *w)
+{
+	const __m128i right = _mm_cvtsi32_si128(m), left = _mm_cvtsi32_si128(32 - m);
+	__m256i hi, lo;
+	int i;
+
+	for (i = 0; i + 8 < n; i += 8) {
+		lo = _mm256_loadu_si256((const __m256i *)(u + i));
+		hi = _mm256_loadu_si256((const __m256i *)(u + i + 1));
+		_mm256_storeu_si256((__m256i *)(w + i),
+			_mm256_or_si256(_mm256_srl_epi32(lo, right), _mm256_sll_epi32(hi, left)));
+	}
+
+	return i;
+}
+
+#endif
+
+
+//picked once from what the processor supports
+static const word_kernels &
+vector_kernels()
+{
+	static const word_kernels chosen = [] {
+		word_kernels k = { no_bitwise, no_shift, no_shift };
+
+#ifdef ALGO_BIGINT_X86
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("avx2")) {
+			k = { bitwise_avx2, shift_left_avx2, shift_right_avx2 };
+		}
+#endif
+
+		return k;
+	}();
+
+	return chosen;
+}
+
+
+//a = a op b over n limbs for op '&', '|' or '^'; '~' complements a alone
+static void
+bitwise_words(int n, uint32_t *a, const uint32_t *b, char op)
+{
+	int i = vector_kernels().bitwise(n, a, b, op);
+
+	switch (op) {
+	case '&':
+		for (; i < n; i++) {
+			a[i] &= b[i];
+		}
+		break;
+	case '|':
+		for (; i < n; i++) {
+			a[i] |= b[i];
+		}
+		break;
+	case '^':
+		for (; i < n; i++) {
+			a[i] ^= b[i];
+		}
+		break;
+	default:
+		for (; i < n; i++) {
+			a[i] = ~a[i];
+		}
+		break;
+	}
+}
+
+
+//w[0..n] = u << m for 0 < m < 32, w must not overlap u
+static void
+shift_left_words(int n, const uint32_t *u, int m, uint32_t *w)
+{
+	int i;
+
+	w[0] = u[0] << m;
+	for (i = 1 + vector_kernels().shift_left(n, u, m, w); i < n; i++) {
+		w[i] = (u[i] << m) | (u[i - 1] >> (32 - m));
+	}
+	w[n] = u[n - 1] >> (32 - m);
+}
+
+
+//w[0..n-1] = u >> m for 0 < m < 32, dropping the bits shifted out
+static void
+shift_right_words(int n, const uint32_t *u, int m, uint32_t *w)
+{
+	int i;
+
+	for (i = vector_kernels().shift_right(n, u, m, w); i < n - 1; i++) {
+		w[i] = (u[i] >> m) | (u[i + 1] << (32 - m));
+	}
+	w[n - 1] = u[n - 1] >> m;
+}
+
+
+static void
+algorithm_d(int m, int n, uint32_t *u, uint32_t *v, uint32_t *q)
+{
+	int shift;
+	int j, i;
+	uint64_t qhat, rhat, p, t, k, k2;
+	uint32_t d;
+
+	assert(n > 0 && "v must be greater than zero!");
+	assert(v[n - 1] != 0 && "v must not have leading zeros!");
+
+	if (n == 1) {
+		short_division(m + n, u, v[0], q, &u[0]);
+		return;
+	}
+
+	u[m + n] = 0;
+	shift = leading_zeros(v[n-1]);
+	if (shift) {
+			shift_left(n, v, shift);
+			shift_left(m + n + 1, u, shift);
+	}
+
+	for (j = m; j >= 0; j--) {
+		t = ((uint64_t)u[j + n] << 32) | u[j + n - 1];
+		qhat = t / v[n - 1];
+		rhat = t % v[n - 1];
+
+		while (true) {
+			assert(n >= 2);
+			if (qhat > UINT32_MAX || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])) {
+				qhat--;
+				rhat += v[n - 1];
+				if (rhat <= UINT32_MAX) {
+					continue;
+				}
+			}
+			break;
+		}
+
+		k = 0;
+		for (i = 0; i <= n; i++) {
+			p = qhat * (i == n ? 0 : v[i]);
+			k2 = (p >> 32);
+
+			d = u[j + i] - (uint32_t)p;
+			k2 += (d > u[j + i]);
+
+			u[j + i] = d - (uint32_t)k;
+			k2 += (u[j + i] > d);
+
+			k = k2;
+		}
+
+		q[j] = qhat;
+		if (k != 0) {
+			q[j]--;
+			k = 0;
+			for (i = 0; i < n; i++) {
+				t = (uint64_t)u[j + i] + v[i] + k;
+				u[j + i] = (uint32_t)t;
+				k = t >> 32;
+			}
+			u[j + n] += k;
+		}
+	}
+
+	if (shift) {
+		shift_right(n, u, shift);
+	}
+}
+
+
+static void
+algorithm_d_wrapper(int m, int n, const uint32_t *u, const uint32_t *v, uint32_t *q, uint32_t *r)
+{
+	scratch_frame frame;
+	uint32_t *u_copy = frame.take(m + n + 1);
+	uint32_t *v_copy = frame.take(n);
+	int i;
+
+	assert(n > 0 && "Division by zero!");
+	assert(v[n - 1] != 0 && "v has leading zero!");
+
+	for (i = 0; i < m + n; i++) {
+		u_copy[i] = u[i];
+	}
+	u_copy[m + n] = 0;
+
+	for (i = 0; i < n; i++) {
+		v_copy[i] = v[i];
+	}
+
+	algorithm_d(m, n, u_copy, v_copy, q);
+
+	for (i = 0; i < n; i++) {
+		r[i] = u_copy[i];
+	}
+}
+
+
+#define BURNIKEL_ZIEGLER_THRESHOLD 80
+#define BURNIKEL_ZIEGLER_OFFSET 40
+
+
+//trimmed limb vectors used by the recursive algorithms
+typedef algo::bigint::Limbs nat;
+
+
+static void
+nat_trim(nat &x)
+{
+	x.resize(trimmed_length(x.size(), x.data()));
+}
+
+
+static nat
+nat_u64(uint64_t x)
+{
+	nat w(2);
+
+	w[0] = (uint32_t)x;
+	w[1] = (uint32_t)(x >> 32);
+	nat_trim(w);
+
+	return w;
+}
+
+
+static int
+nat_cmp(const nat &x, const nat &y)
+{
+	return bigint_cmp(x.size(), x.data(), y.size(), y.data());
+}
+
+
+static int
+nat_bit_length(const nat &x)
+{
+	if (x.empty()) {
+		return 0;
+	}
+
+	return x.size() * 32 - leading_zeros(x.back());
+}
+
+
+static nat
+nat_add(const nat &x, const nat &y)
+{
+	const nat &a = (x.size() >= y.size()) ? x : y;
+	const nat &b = (x.size() >= y.size()) ? y : x;
+	nat w(a.size() + 1);
+
+	std::copy(a.begin(), a.end(), w.begin());
+	add_into(w.size(), w.data(), b.size(), b.data());
+	nat_trim(w);
+
+	return w;
+}
+
+
+static nat
+nat_sub(const nat &x, const nat &y)
+{
+	nat w(x);
+
+	sub_from(w.size(), w.data(), y.size(), y.data());
+	nat_trim(w);
+
+	return w;
+}
+
+
+static nat
+nat_mul(const nat &x, const nat &y)
+{
+	nat w(x.size() + y.size());
+
+	multiply(x.size(), y.size(), x.data(), y.data(), w.data());
+	nat_trim(w);
+
+	return w;
+}
+
+
+static nat
+nat_slice(const nat &x, int from, int len)
+{
+	int to = (from + len < (int)x.size()) ? from + len : x.size();
+	nat w;
+
+	if (from < to) {
+		w.assign(x.begin() + from, x.begin() + to);
+		nat_trim(w);
+	}
+
+	return w;
+}
+
+
+//hi * B^k + lo, for lo < B^k
+static nat
+nat_join(const nat &lo, const nat &hi, int k)
+{
+	nat w(lo);
+
+	if (hi.empty()) {
+		return w;
+	}
+
+	w.resize(k, 0);
+	w.insert(w.end(), hi.begin(), hi.end());
+
+	return w;
+}
+
+
+//the len limbs at x shifted left, read in place
+static nat
+words_shift_left(int len, const uint32_t *x, int bits)
+{
+	nat w;
+
+	if (len == 0) {
+		return w;
+	}
+
+	w.assign(bits / 32, 0);
+	w.insert(w.end(), x, x + len);
+	w.push_back(0);
+
+	if (bits % 32) {
+		shift_left(w.size() - bits / 32, w.data() + bits / 32, bits % 32);
+	}
+	nat_trim(w);
+
+	return w;
+}
+
+
+static nat
+nat_shift_left(const nat &x, int bits)
+{
+	return words_shift_left(x.size(), x.data(), bits);
+}
+
+
+static nat
+nat_shift_right(const nat &x, int bits)
+{
+	nat w;
+
+	if ((int)x.size() <= bits / 32) {
+		return w;
+	}
+
+	w.assign(x.begin() + bits / 32, x.end());
+
+	if (bits % 32) {
+		//the low bits shifted out are discarded, not carried
+		w[0] &= ~(uint32_t)0 << (bits % 32);
+		shift_right(w.size(), w.data(), bits % 32);
+	}
+	nat_trim(w);
+
+	return w;
+}
+
+
+//the Knuth division of trimmed limbs read in place
+static void
+knuth_words(int a_len, const uint32_t *a, int b_len, const uint32_t *b, nat &q, nat &r)
+{
+	int m, n;
+
+	if (bigint_cmp(a_len, a, b_len, b) < 0) {
+		q.clear();
+		r.assign(a, a + a_len);
+		return;
+	}
+
+	n = b_len;
+	m = a_len - n;
+
+	q.assign(m + 1, 0);
+	r.assign(n, 0);
+
+	algorithm_d_wrapper(m, n, a, b, q.data(), r.data());
+
+	nat_trim(q);
+	nat_trim(r);
+}
+
+
+static void
+nat_divrem_knuth(const nat &a, const nat &b, nat &q, nat &r)
+{
+	knuth_words(a.size(), a.data(), b.size(), b.data(), q, r);
+}
+
+
+static void div_3n_2n(const nat &a, const nat &b, int h, nat &q, nat &r);
+
+
+//a < b * B^n, where b has exactly n limbs and its top bit set
+static void
+div_2n_1n(const nat &a, const nat &b, int n, nat &q, nat &r)
+{
+	nat q1, r1;
+	int h;
+
+	if ((n & 1) || n < BURNIKEL_ZIEGLER_THRESHOLD) {
+		nat_divrem_knuth(a, b, q, r);
+		return;
+	}
+
+	h = n / 2;
+
+	div_3n_2n(nat_slice(a, h, a.size()), b, h, q1, r1);
+	div_3n_2n(nat_join(nat_slice(a, 0, h), r1, h), b, h, q, r);
+
+	q = nat_join(q, q1, h);
+}
+
+
+//a < b * B^h, where b has exactly 2h limbs and its top bit set
+static void
+div_3n_2n(const nat &a, const nat &b, int h, nat &q, nat &r)
+{
+	nat a1 = nat_slice(a, 2 * h, a.size());
+	nat a12 = nat_slice(a, h, a.size());
+	nat b1 = nat_slice(b, h, h);
+	nat b2 = nat_slice(b, 0, h);
+	nat d, one(1, 1);
+
+	if (nat_cmp(a1, b1) < 0) {
+		div_2n_1n(a12, b1, h, q, r);
+		d = nat_mul(q, b2);
+	} else {
+		q.assign(h, UINT32_MAX);
+		r = nat_sub(nat_add(a12, b1), nat_join(nat(), b1, h));
+		d = nat_sub(nat_join(nat(), b2, h), b2);
+	}
+
+	r = nat_join(nat_slice(a, 0, h), r, h);
+
+	while (nat_cmp(r, d) < 0) {
+		r = nat_add(r, b);
+		q = nat_sub(q, one);
+	}
+
+	r = nat_sub(r, d);
+}
+
+
+//a / b and a % b for trimmed limbs read in place: only the normalized
+//copies that Knuth's and Burnikel and Ziegler's algorithms shift anyway
+//are made, so views divide without copying their operands first
+static void
+divrem_words(int a_len, const uint32_t *a, int s, const uint32_t *b, nat &q, nat &r)
+{
+	int m, n, t, i, sigma;
+	nat as, bs, z, qi, ri;
+
+	assert(s > 0 && "Division by zero!");
+
+	if (s < BURNIKEL_ZIEGLER_THRESHOLD || a_len - s < BURNIKEL_ZIEGLER_OFFSET) {
+		knuth_words(a_len, a, s, b, q, r);
+		return;
+	}
+
+	//pad b to n = j * m limbs, m a power of two, so that the recursion
+	//halves evenly down to the Knuth base case
+	for (m = 1; m * BURNIKEL_ZIEGLER_THRESHOLD <= s; m <<= 1);
+	n = (s + m - 1) / m * m;
+
+	sigma = n * 32 - (s * 32 - leading_zeros(b[s - 1]));
+	bs = words_shift_left(s, b, sigma);
+	as = words_shift_left(a_len, a, sigma);
+
+	t = (nat_bit_length(as) + n * 32) / (n * 32);
+	if (t < 2) {
+		t = 2;
+	}
+
+	q.assign((t - 1) * n, 0);
+	z = nat_slice(as, (t - 2) * n, 2 * n);
+
+	for (i = t - 2; i >= 0; i--) {
+		div_2n_1n(z, bs, n, qi, ri);
+		std::copy(qi.begin(), qi.end(), q.begin() + i * n);
+
+		if (i > 0) {
+			z = nat_join(nat_slice(as, (i - 1) * n, n), ri, n);
+		}
+	}
+
+	nat_trim(q);
+	r = nat_shift_right(ri, sigma);
+}
+
+
+static void
+nat_divrem(const nat &a, const nat &b, nat &q, nat &r)
+{
+	divrem_words(a.size(), a.data(), b.size(), b.data(), q, r);
+}
+
+
+static void
+multiply_add(uint32_t *u, int *m, uint32_t x, uint32_t y)
+{
+	int i;
+	uint32_t k, hi_prod, lo_prod;
+
+	k = y;
+
+	for (i = 0; i < *m; i++) {
+		mul_32_by_32(u[i], x, &hi_prod, &lo_prod);
+		lo_prod += k;
+		k = hi_prod + (lo_prod < k);
+		u[i] = lo_prod;
+	}
+
+	if (k) {
+		u[*m] = k;
+		(*m)++;
+	}
+}
+
+
+//u = u * x for a 64-bit x, returning the carry out of the top limb;
+//without a 128-bit type x is taken in two 32-bit halves
+static uint64_t
+multiply_word(int n, uint32_t *u, uint64_t x)
+{
+	uint64_t k, p0, p1;
+	int i;
+
+	k = 0;
+#ifdef ALGO_BIGINT_WORD64
+	uint128_t t;
+
+	for (i = 0; i + 1 < n; i += 2) {
+		t = (uint128_t)load_word(u + i) * x + k;
+		store_word(u + i, (uint64_t)t);
+		k = (uint64_t)(t >> 64);
+	}
+
+	if (i < n) {
+		t = (uint128_t)u[i] * x + k;
+		u[i] = (uint32_t)t;
+		k = (uint64_t)(t >> 32);
+	}
+
+	return k;
+#endif
+
+	for (i = 0; i < n; i++) {
+		p0 = (uint64_t)u[i] * (uint32_t)x + (uint32_t)k;
+		p1 = (uint64_t)u[i] * (x >> 32) + (k >> 32) + (p0 >> 32);
+		u[i] = (uint32_t)p0;
+		k = p1;
+	}
+
+	return k;
+}
+
+static void
+bigint_from_string(int n, const char *str, int *u_len, uint32_t *u)
+{
+	uint32_t chunk;
+	int i;
+
+	static const uint32_t pow10s[] = {
+		1000000000,
+		10,
+		100,
+		1000,
+		10000,
+		100000,
+		1000000,
+		10000000,
+		100000000
+	};
+
+	*u_len = 0;
+	chunk = 0;
+
+	for (i = 1; i <= n; i++) {
+		assert(*str >= '0' && *str <= '9');
+		chunk = chunk * 10 + *str++ - '0';
 
 		if (i % 9 == 0 || i == n) {
 			multiply_add(u, u_len, pow10s[i % 9], chunk);
@@ -393,332 +1832,2197 @@ bigint_from_string(int n, const char *str, int *u_len, uint32_t *u)
 }
 
 
-static void
-bigint_to_string(int n, const uint32_t *u, char *str)
+static void
+bigint_to_string(int n, const uint32_t *u, char *str)
+{
+	scratch_frame frame;
+	uint32_t *v = frame.take(n);
+	uint32_t k;
+	char *s, t;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		v[i] = u[i];
+	}
+
+	while (n && v[n - 1] == 0) n--;
+
+	if (n == 0) {
+		str[0] = '0';
+		str[1] = '\0';
+		return;
+	}
+
+	s = str;
+	while (n != 0) {
+		short_division(n, v, 1000000000, v, &k);
+		while (n && v[n - 1] == 0) {
+			n--;
+		}
+
+		for (i = 0; (n != 0 && i < 9) || k; i++) {
+			*s++ = '0' + (k % 10);
+			k /= 10;
+		}
+	}
+
+	*s-- = '\0';
+	while (str < s) {
+		t = *str;
+		*str++ = *s;
+		*s-- = t;
+	}
+}
+
+
+//w = u - w over n limbs, w zero-extended to n
+static void
+sub_reverse(int n, uint32_t *w, int w_len, const uint32_t *u)
+{
+	bool borrow;
+	int i;
+
+	borrow = algorithm_s(w_len, u, w, w);
+
+	for (i = w_len; i < n; i++) {
+		w[i] = u[i] - borrow;
+		borrow = borrow && (u[i] == 0);
+	}
+
+	assert(!borrow && "Nothing to borrow from!");
+}
+
+
+//x = x + (-1)^y_neg * y, in x's own buffer
+static void
+add_signed(nat &x, bool &x_neg, const nat &y_ref, bool y_neg)
+{
+	const nat *y = &y_ref;
+	int x_len, y_len;
+	nat copy;
+
+	if (&x == &y_ref) {
+		copy = y_ref;
+		y = &copy;
+	}
+
+	x_len = trimmed_length(x.size(), x.data());
+	y_len = trimmed_length(y->size(), y->data());
+
+	if (x_neg == y_neg) {
+		x.resize((x_len > y_len ? x_len : y_len) + 1, 0);
+		add_into(x.size(), x.data(), y_len, y->data());
+	} else if (bigint_cmp(x_len, x.data(), y_len, y->data()) >= 0) {
+		sub_from(x_len, x.data(), y_len, y->data());
+	} else {
+		x.resize(y_len, 0);
+		sub_reverse(y_len, x.data(), x_len, y->data());
+		x_neg = y_neg;
+	}
+
+	nat_trim(x);
+	if (x.empty()) {
+		x_neg = false;
+	}
+}
+
+
+//w = w + (-1)^neg * u * v in w's own buffer, neither u nor v being w.
+//Products below the Karatsuba size of the same sign accumulate straight
+//into w; the rest are formed in the workspace and added or subtracted.
+static void
+addmul_signed(nat &w, bool &w_neg, const nat &u_ref, const nat &v_ref, bool neg)
+{
+	const nat *u = &u_ref, *v = &v_ref;
+	int w_len = w.size(), m, n, len;
+
+	if (u->size() < v->size()) {
+		std::swap(u, v);
+	}
+	m = u->size();
+	n = v->size();
+
+	if (n == 0) {
+		return;
+	}
+
+	if (w_neg == neg || w_len == 0) {
+		w_neg = neg;
+		len = (w_len > m + n ? w_len : m + n) + 1;
+		w.resize(len, 0);
+
+		if (n < KARATSUBA_THRESHOLD) {
+			algorithm_m_accumulate(len, w.data(), m, n, u->data(), v->data());
+		} else {
+			scratch_frame frame;
+			uint32_t *p = frame.take(m + n);
+
+			multiply(m, n, u->data(), v->data(), p);
+			add_into(len, w.data(), m + n, p);
+		}
+	} else {
+		scratch_frame frame;
+		uint32_t *p = frame.take(m + n);
+
+		multiply(m, n, u->data(), v->data(), p);
+		len = trimmed_length(m + n, p);
+
+		if (bigint_cmp(w_len, w.data(), len, p) >= 0) {
+			sub_from(w_len, w.data(), len, p);
+		} else {
+			w.resize(len, 0);
+			sub_reverse(len, w.data(), w_len, p);
+			w_neg = neg;
+		}
+	}
+
+	nat_trim(w);
+	if (w.empty()) {
+		w_neg = false;
+	}
+}
+
+//x mod m for x < B^(2k), k = m.size(), with mu = B^(2k) / m: costs two
+//multiplications and at most two corrective subtractions
+static nat
+barrett_reduce(const nat &x, const nat &m, const nat &mu)
+{
+	int k = m.size();
+	nat q, r, qm;
+
+	if ((int)x.size() > 2 * k) {
+		nat_divrem(x, m, q, r);
+		return r;
+	}
+
+	if (nat_cmp(x, m) < 0) {
+		return x;
+	}
+
+	q = nat_slice(nat_mul(nat_slice(x, k - 1, x.size()), mu), k + 1, 2 * k + 2);
+	qm = nat_slice(nat_mul(q, m), 0, k + 1);
+	r = nat_slice(x, 0, k + 1);
+
+	if (nat_cmp(r, qm) < 0) {
+		r.resize(k + 2, 0);
+		r[k + 1] = 1;
+	}
+	r = nat_sub(r, qm);
+
+	while (nat_cmp(r, m) >= 0) {
+		r = nat_sub(r, m);
+	}
+
+	return r;
+}
+
+
+static int
+nat_bit(const nat &x, int i)
+{
+	return (x[i / 32] >> (i % 32)) & 1;
+}
+
+
+//x reduced into [0, m)
+static nat
+nat_residue(const nat &x, bool negative, const nat &m)
+{
+	nat q, r;
+
+	nat_divrem(x, m, q, r);
+
+	if (negative && !r.empty()) {
+		r = nat_sub(m, r);
+	}
+
+	return r;
+}
+
+
+//-n0^-1 mod 2^32 for odd n0, by Newton iteration on the 2-adic inverse
+static uint32_t
+montgomery_inverse(uint32_t n0)
+{
+	uint32_t x = n0;
+	int i;
+
+	assert((n0 & 1) && "Montgomery modulus must be odd!");
+
+	for (i = 0; i < 4; i++) {
+		x *= 2 - n0 * x;
+	}
+
+	return -x;
+}
+
+
+//REDC of the 2k + 1 limbs in t: leaves t / R mod n in t[k .. 2k)
+static void
+montgomery_redc(int k, uint32_t *t, const uint32_t *n, uint32_t n_inv)
+{
+	int i;
+
+	for (i = 0; i < k; i++) {
+		carry_into(k + 1 - i, t + i + k, addmul_1(k, n, t[i] * n_inv, t + i));
+	}
+
+	if (t[2 * k] || bigint_cmp(k, t + k, k, n) >= 0) {
+		sub_from(k + 1, t + k, k, n);
+	}
+}
+
+
+static void
+montgomery_mul(int k, const uint32_t *a, const uint32_t *b, const uint32_t *n,
+	uint32_t n_inv, uint32_t *t, uint32_t *w)
+{
+	multiply(k, k, a, b, t);
+	t[2 * k] = 0;
+
+	montgomery_redc(k, t, n, n_inv);
+	std::copy(t + k, t + 2 * k, w);
+}
+
+
+static int
+window_size(int bits)
+{
+	if (bits <= 24) return 1;
+	if (bits <= 80) return 3;
+	if (bits <= 240) return 4;
+	if (bits <= 672) return 5;
+
+	return 6;
+}
+
+
+//sliding window recoding: digits[j] is the odd window value whose lowest
+//bit sits at position j, or zero
+static void
+window_digits(const nat &e, int w, std::vector<int> &digits)
+{
+	int i, j, b;
+
+	digits.assign(nat_bit_length(e), 0);
+
+	for (i = digits.size() - 1; i >= 0; i = j - 1) {
+		if (!nat_bit(e, i)) {
+			j = i;
+			continue;
+		}
+
+		for (j = (i - w + 1 > 0) ? i - w + 1 : 0; !nat_bit(e, j); j++);
+
+		for (b = i; b >= j; b--) {
+			digits[j] = (digits[j] << 1) | nat_bit(e, b);
+		}
+	}
+}
+
+
+#define RADIX_THRESHOLD 60
+
+
+//10^(9 * 2^k), grown on demand by repeated squaring; the cache outlives
+//any arena installed by the caller so it allocates from new/delete
+static const nat &
+decimal_power(int k)
+{
+	static thread_local std::vector<nat> powers;
+
+	if (powers.empty()) {
+		powers.emplace_back(std::pmr::new_delete_resource());
+		powers.back().assign(1, 1000000000);
+	}
+
+	//a moved-from nat is unbound, so each power starts a bound one
+	while ((int)powers.size() <= k) {
+		nat power(std::pmr::new_delete_resource());
+
+		power = nat_mul(powers.back(), powers.back());
+		powers.push_back(std::move(power));
+	}
+
+	return powers[k];
+}
+
+
+static nat
+nat_from_decimal(const char *str, int n)
+{
+	int k, low;
+	nat u;
+
+	if (n <= RADIX_THRESHOLD * 9) {
+		u.resize(n / 9 + 1);
+		bigint_from_string(n, str, &low, u.data());
+		u.resize(low);
+		return u;
+	}
+
+	//split off the largest 9 * 2^k digit block that leaves a nonempty head
+	for (k = 0; 9 << (k + 1) < n; k++);
+
+	low = 9 << k;
+	u = nat_mul(nat_from_decimal(str, n - low), decimal_power(k));
+
+	return nat_add(u, nat_from_decimal(str + n - low, low));
+}
+
+
+//text nat_to_decimal has produced so far; with a sink it is handed over
+//whenever DECIMAL_FLUSH characters have gathered, so the whole number is
+//never held as text
+struct decimal_out {
+	std::string text;
+	const algo::bigint::ByteSink *sink;
+};
+
+
+#define DECIMAL_FLUSH (1 << 16)
+
+
+//appends x, which must be below 10^(9 * 2^(k + 1)); with pad set the
+//output is zero-filled to exactly that many digits
+static void
+nat_to_decimal(const nat &x, int k, bool pad, decimal_out &out)
+{
+	nat q, r;
+	int digits = 9 << (k + 1);
+	size_t start;
+
+	if (k < 0 || (int)x.size() <= RADIX_THRESHOLD) {
+		start = out.text.size();
+		out.text.resize(start + x.size() * 10 + 2);
+		bigint_to_string(x.size(), x.data(), &out.text[start]);
+		out.text.resize(start + std::strlen(&out.text[start]));
+
+		if (pad) {
+			out.text.insert(start, digits - (out.text.size() - start), '0');
+		}
+
+		if (out.sink && out.text.size() >= DECIMAL_FLUSH) {
+			(*out.sink)(out.text.data(), out.text.size());
+			out.text.clear();
+		}
+		return;
+	}
+
+	nat_divrem(x, decimal_power(k), q, r);
+
+	if (!pad && q.empty()) {
+		nat_to_decimal(r, k - 1, false, out);
+		return;
+	}
+
+	nat_to_decimal(q, k - 1, pad, out);
+	nat_to_decimal(r, k - 1, true, out);
+}
+
+
+//the level k with 10^(9 * 2^(k + 1)) above x
+static int
+decimal_level(const nat &x)
+{
+	int k;
+
+	for (k = 0; (int)decimal_power(k).size() * 2 < (int)x.size(); k++);
+
+	return k;
+}
+
+
+void
+algo::bigint::BigInt::normalize()
+{
+	nat_trim(repr);
+
+	if (repr.empty()) {
+		negative = false;
+		bits = 0;
+	} else {
+		bits = repr.size() * 32 - leading_zeros(repr.back());
+	}
+}
+
+
+algo::bigint::Limbs
+algo::bigint::BigInt::from_string(const char *string)
+{
+	int n = std::strlen(string);
+
+	negative = false;
+
+	assert(n > 0 && "Empty string is not a valid number.");
+
+	if (string[0] == '-') {
+		assert(n > 1 && "Just '-' is not a valid number.");
+		negative = true;
+		string++;
+		n--;
+	}
+
+	return nat_from_decimal(string, n);
+}
+
+
+std::string
+algo::bigint::BigInt::to_string() const
+{
+	decimal_out out = { std::string(), nullptr };
+
+	if (negative) {
+		out.text.push_back('-');
+	}
+
+	nat_to_decimal(repr, decimal_level(repr), false, out);
+
+	return std::move(out.text);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::from_bytes(const uint8_t *bytes, int len, bool big_endian, bool negative)
+{
+	nat w((len + 3) / 4);
+	int i, j;
+
+	for (i = 0; i < len; i++) {
+		j = big_endian ? len - 1 - i : i;
+		w[j / 4] |= (uint32_t)bytes[i] << (8 * (j % 4));
+	}
+
+	return BigInt(std::move(w), negative);
+}
+
+
+static int
+hex_digit(char c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+
+	return -1;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::from_hex(const char *hex)
+{
+	bool negative = false;
+	int n, i, j, d;
+	nat w;
+
+	if (*hex == '-') {
+		negative = true;
+		hex++;
+	}
+	if (hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) {
+		hex += 2;
+	}
+
+	n = std::strlen(hex);
+	assert(n > 0 && "Empty string is not a valid number.");
+
+	w.resize((n + 7) / 8);
+	for (i = 0; i < n; i++) {
+		d = hex_digit(hex[i]);
+		assert(d >= 0 && "Not a hex digit.");
+
+		j = n - 1 - i;
+		w[j / 8] |= (uint32_t)d << (4 * (j % 8));
+	}
+
+	return BigInt(std::move(w), negative);
+}
+
+
+std::string
+algo::bigint::BigInt::to_hex() const
+{
+	static const char digits[] = "0123456789abcdef";
+	std::string out;
+	int i, j;
+
+	if (repr.empty()) {
+		return "0";
+	}
+
+	if (negative) {
+		out.push_back('-');
+	}
+
+	out.reserve(out.size() + (bits + 3) / 4);
+	for (j = (bits + 3) / 4 - 1; j >= 0; j--) {
+		i = j / 8;
+		out.push_back(digits[(repr[i] >> (4 * (j % 8))) & 15]);
+	}
+
+	return out;
+}
+
+
+void
+algo::bigint::BigInt::to_bytes(uint8_t *bytes, int len, bool big_endian) const
+{
+	int i, j;
+
+	assert((size_t)len * 8 >= bits && "Byte buffer too small!");
+
+	for (j = 0; j < len; j++) {
+		i = big_endian ? len - 1 - j : j;
+		bytes[i] = (j / 4 < (int)repr.size()) ? (uint8_t)(repr[j / 4] >> (8 * (j % 4))) : 0;
+	}
+}
+
+
+std::vector<uint8_t>
+algo::bigint::BigInt::to_bytes(bool big_endian) const
+{
+	std::vector<uint8_t> bytes((bits + 7) / 8);
+
+	to_bytes(bytes.data(), bytes.size(), big_endian);
+
+	return bytes;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::operator+=(const BigInt &op)
+{
+	add_signed(repr, negative, op.repr, op.negative);
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::operator-=(const BigInt &op)
+{
+	add_signed(repr, negative, op.repr, !op.negative);
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::operator*=(const BigInt &op)
+{
+	int m = repr.size();
+	int n = op.repr.size();
+	scratch_frame frame;
+	uint32_t *w;
+
+	if (m == 0 || n == 0) {
+		repr.clear();
+		normalize();
+		return *this;
+	}
+
+	//the product goes through the workspace the kernels already draw
+	//from and has bits + op.bits or one fewer bits
+	w = frame.take(m + n);
+	multiply(m, n, repr.data(), op.repr.data(), w);
+
+	repr.assign(w, w + (bits + op.bits + 31) / 32);
+	negative ^= op.negative;
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::operator/=(const BigInt &op)
+{
+	nat q, r;
+
+	assert(!op.repr.empty() && "Division by zero!");
+
+	if (bits < op.bits) {
+		repr.clear();
+		normalize();
+		return *this;
+	}
+
+	nat_divrem(repr, op.repr, q, r);
+
+	repr.swap(q);
+	negative ^= op.negative;
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::operator%=(const BigInt &op)
+{
+	nat q, r;
+
+	assert(!op.repr.empty() && "Division by zero!");
+
+	if (bits < op.bits) {
+		return *this;
+	}
+
+	nat_divrem(repr, op.repr, q, r);
+
+	repr.swap(r);
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::addmul(const BigInt &u, const BigInt &v)
+{
+	if (&u == this || &v == this) {
+		return *this += u * v;
+	}
+
+	addmul_signed(repr, negative, u.repr, v.repr, u.negative ^ v.negative);
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::submul(const BigInt &u, const BigInt &v)
+{
+	if (&u == this || &v == this) {
+		return *this -= u * v;
+	}
+
+	addmul_signed(repr, negative, u.repr, v.repr, !(u.negative ^ v.negative));
+	normalize();
+
+	return *this;
+}
+
+//the scalar operators come here with the operand split into magnitude and
+//sign; the magnitude fits the limbs kept inline, so nothing is allocated
+algo::bigint::BigInt &
+algo::bigint::BigInt::add_word(uint64_t op, bool op_negative)
+{
+	add_signed(repr, negative, nat_u64(op), op_negative);
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::mul_word(uint64_t op, bool op_negative)
+{
+	uint64_t k;
+
+	if (op == 0) {
+		repr.clear();
+	}
+
+	k = multiply_word(repr.size(), repr.data(), op);
+	for (; k; k >>= 32) {
+		repr.push_back((uint32_t)k);
+	}
+
+	negative ^= op_negative;
+	normalize();
+
+	return *this;
+}
+
+
+//short_division for divisors of one limb, algorithm D on two limbs above
+algo::bigint::BigInt &
+algo::bigint::BigInt::div_word(uint64_t op, bool op_negative, bool remainder)
+{
+	uint32_t r;
+	nat q, rem;
+
+	assert(op > 0 && "Division by zero!");
+
+	if (repr.empty()) {
+		return *this;
+	}
+
+	if (op <= UINT32_MAX) {
+		short_division(repr.size(), repr.data(), (uint32_t)op, repr.data(), &r);
+		if (remainder) {
+			repr.assign(1, r);
+		}
+	} else {
+		nat_divrem(repr, nat_u64(op), q, rem);
+		repr.swap(remainder ? rem : q);
+	}
+
+	if (!remainder) {
+		negative ^= op_negative;
+	}
+	normalize();
+
+	return *this;
+}
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator+(const BigInt &op) const &
+{
+	BigInt w;
+
+	w.repr.reserve((repr.size() > op.repr.size() ? repr.size() : op.repr.size()) + 1);
+	w.repr.assign(repr.begin(), repr.end());
+	w.negative = negative;
+
+	return w += op;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator+(const BigInt &op) &&
+{
+	return std::move(*this += op);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator-(const BigInt &op) const &
+{
+	BigInt w;
+
+	w.repr.reserve((repr.size() > op.repr.size() ? repr.size() : op.repr.size()) + 1);
+	w.repr.assign(repr.begin(), repr.end());
+	w.negative = negative;
+
+	return w -= op;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator-(const BigInt &op) &&
+{
+	return std::move(*this -= op);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator*(const BigInt &op) const &
+{
+	int m = repr.size();
+	int n = op.repr.size();
+	nat w;
+
+	if (m == 0 || n == 0) {
+		return BigInt();
+	}
+
+	w.resize(m + n);
+	multiply(m, n, repr.data(), op.repr.data(), w.data());
+	w.resize((bits + op.bits + 31) / 32);
+
+	return BigInt(std::move(w), negative ^ op.negative);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator*(const BigInt &op) &&
+{
+	return std::move(*this *= op);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator/(const BigInt &op) const &
+{
+	return BigInt(*this) /= op;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator/(const BigInt &op) &&
+{
+	return std::move(*this /= op);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator%(const BigInt &op) const &
+{
+	return BigInt(*this) %= op;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator%(const BigInt &op) &&
+{
+	return std::move(*this %= op);
+}
+
+
+bool
+algo::bigint::BigInt::operator==(const BigInt &op) const
+{
+	return negative == op.negative && bits == op.bits && repr == op.repr;
+}
+
+
+bool
+algo::bigint::BigInt::operator!=(const BigInt &op) const
+{
+	return !(*this == op);
+}
+
+
+int
+algo::bigint::BigInt::compare(const BigInt &op) const
+{
+	int sign = negative ? -1 : 1;
+
+	if (negative != op.negative) {
+		return sign;
+	}
+
+	if (bits != op.bits) {
+		return bits < op.bits ? -sign : sign;
+	}
+
+	return sign * bigint_cmp(repr.size(), repr.data(), op.repr.size(), op.repr.data());
+}
+
+
+bool
+algo::bigint::BigInt::operator<(const BigInt &op) const
+{
+	return compare(op) < 0;
+}
+
+
+bool
+algo::bigint::BigInt::operator<=(const BigInt &op) const
+{
+	return compare(op) <= 0;
+}
+
+
+bool
+algo::bigint::BigInt::operator>(const BigInt &op) const
+{
+	return compare(op) > 0;
+}
+
+
+bool
+algo::bigint::BigInt::operator>=(const BigInt &op) const
+{
+	return compare(op) >= 0;
+}
+
+
+size_t
+std::hash<algo::bigint::BigInt>::operator()(const algo::bigint::BigInt &x) const
+{
+	const algo::bigint::Limbs &limbs = x.limbs();
+
+	return algo::hash::murmur3((const uint8_t *)limbs.data(), limbs.size() * sizeof(uint32_t), x.is_negative());
+}
+
+
+//n limbs of the two's complement form of (-1)^neg * x, n > x.size()
+static void
+twos_complement(const nat &x, bool neg, int n, uint32_t *w)
+{
+	int i;
+
+	std::copy(x.begin(), x.end(), w);
+	std::fill(w + x.size(), w + n, 0);
+
+	if (!neg) {
+		return;
+	}
+
+	//~(x - 1); x is nonzero so the borrow stops inside it
+	for (i = 0; w[i] == 0; i++) {
+		w[i] = UINT32_MAX;
+	}
+	w[i]--;
+
+	bitwise_words(n, w, nullptr, '~');
+}
+
+
+//x = x op y on two's complement forms one limb wider than either operand,
+//so the top limb holds nothing but the result's sign
+static void
+bitwise(nat &x, bool &x_neg, const nat &y, bool y_neg, char op)
+{
+	scratch_frame frame;
+	int n = (x.size() > y.size() ? x.size() : y.size()) + 1;
+	uint32_t *a = frame.take(n);
+	uint32_t *b = frame.take(n);
+	bool neg;
+	int i;
+
+	twos_complement(x, x_neg, n, a);
+	twos_complement(y, y_neg, n, b);
+
+	bitwise_words(n, a, b, op);
+
+	neg = a[n - 1] >> 31;
+
+	//back to the magnitude, ~a + 1
+	if (neg) {
+		bitwise_words(n, a, nullptr, '~');
+		for (i = 0; ++a[i] == 0; i++);
+	}
+
+	x.assign(a, a + n);
+	x_neg = neg;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::operator<<=(size_t shift)
+{
+	size_t limbs = shift / 32;
+	int n = repr.size();
+	nat w;
+
+	if (n == 0) {
+		return *this;
+	}
+
+	w.resize(limbs + n + 1);
+	if (shift % 32) {
+		shift_left_words(n, repr.data(), shift % 32, w.data() + limbs);
+	} else {
+		std::copy(repr.begin(), repr.end(), w.begin() + limbs);
+	}
+
+	repr = std::move(w);
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::operator>>=(size_t shift)
+{
+	size_t limbs = shift / 32;
+	int n = repr.size();
+	bool inexact;
+	nat w;
+
+	if (shift >= bits) {
+		//everything shifts out, leaving the sign
+		repr.assign(negative ? 1 : 0, 1);
+		normalize();
+		return *this;
+	}
+
+	//floor division rounds a negative value away from zero when any
+	//nonzero bit is dropped
+	inexact = negative && trailing_zeros() < shift;
+
+	w.resize(n - limbs);
+	if (shift % 32) {
+		shift_right_words(n - limbs, repr.data() + limbs, shift % 32, w.data());
+	} else {
+		std::copy(repr.begin() + limbs, repr.end(), w.begin());
+	}
+
+	if (inexact) {
+		w.push_back(0);
+		for (size_t i = 0; ++w[i] == 0; i++);
+	}
+
+	repr = std::move(w);
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::operator&=(const BigInt &op)
+{
+	bitwise(repr, negative, op.repr, op.negative, '&');
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::operator|=(const BigInt &op)
+{
+	bitwise(repr, negative, op.repr, op.negative, '|');
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt &
+algo::bigint::BigInt::operator^=(const BigInt &op)
+{
+	bitwise(repr, negative, op.repr, op.negative, '^');
+	normalize();
+
+	return *this;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator<<(size_t shift) const &
+{
+	return BigInt(*this) <<= shift;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator<<(size_t shift) &&
+{
+	return std::move(*this <<= shift);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator>>(size_t shift) const &
+{
+	return BigInt(*this) >>= shift;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator>>(size_t shift) &&
+{
+	return std::move(*this >>= shift);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator&(const BigInt &op) const &
+{
+	return BigInt(*this) &= op;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator&(const BigInt &op) &&
+{
+	return std::move(*this &= op);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator|(const BigInt &op) const &
+{
+	return BigInt(*this) |= op;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator|(const BigInt &op) &&
+{
+	return std::move(*this |= op);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator^(const BigInt &op) const &
+{
+	return BigInt(*this) ^= op;
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator^(const BigInt &op) &&
+{
+	return std::move(*this ^= op);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::BigInt::operator~() const
+{
+	BigInt w(repr, !negative);
+
+	return w -= BigInt(nat(1, 1), false);
+}
+
+
+size_t
+algo::bigint::BigInt::popcount() const
+{
+	size_t count = 0;
+
+	for (size_t i = 0; i < repr.size(); i++) {
+		count += __builtin_popcount(repr[i]);
+	}
+
+	return count;
+}
+
+
+size_t
+algo::bigint::BigInt::trailing_zeros() const
+{
+	size_t i;
+
+	if (repr.empty()) {
+		return 0;
+	}
+
+	for (i = 0; repr[i] == 0; i++);
+
+	return i * 32 + __builtin_ctz(repr[i]);
+}
+
+
+bool
+algo::bigint::BigInt::test_bit(size_t i) const
+{
+	size_t zeros;
+	bool bit = i / 32 < repr.size() && ((repr[i / 32] >> (i % 32)) & 1);
+
+	if (!negative) {
+		return bit;
+	}
+
+	//-x = ~(x - 1): below the lowest set bit of x the bits are 0, at it 1,
+	//and above it the complement of x's
+	zeros = trailing_zeros();
+	if (i < zeros) {
+		return false;
+	}
+
+	return i == zeros || !bit;
+}
+
+
+void
+algo::bigint::BigInt::set_bit(size_t i, bool value)
+{
+	nat mask;
+
+	if (negative) {
+		mask.resize(i / 32 + 1);
+		mask.back() = (uint32_t)1 << (i % 32);
+		//clearing ands with ~2^i, which is -(2^i + 1)
+		if (!value) {
+			mask[0] += 1;
+		}
+
+		bitwise(repr, negative, mask, !value, value ? '|' : '&');
+		normalize();
+		return;
+	}
+
+	if (value) {
+		if (i / 32 >= repr.size()) {
+			repr.resize(i / 32 + 1);
+		}
+		repr[i / 32] |= (uint32_t)1 << (i % 32);
+	} else if (i / 32 < repr.size()) {
+		repr[i / 32] &= ~((uint32_t)1 << (i % 32));
+	}
+
+	normalize();
+}
+
+
+algo::bigint::Reducer::Reducer(const BigInt &modulus)
+: mod(modulus.repr)
+{
+	nat power, r;
+
+	assert(!mod.empty() && "Division by zero!");
+
+	power.assign(2 * mod.size() + 1, 0);
+	power.back() = 1;
+
+	nat_divrem(power, mod, mu, r);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::Reducer::reduce(const BigInt &value)
+{
+	return BigInt(barrett_reduce(value.repr, mod, mu), value.negative);
+}
+
+
+void
+algo::bigint::Reducer::reduce(BigInt *values, int count)
+{
+	for (int i = 0; i < count; i++) {
+		values[i].repr = barrett_reduce(values[i].repr, mod, mu);
+		values[i].normalize();
+	}
+}
+
+
+algo::bigint::BigInt
+algo::bigint::Reducer::modpow(const BigInt &base, const BigInt &exponent)
+{
+	const nat &e = exponent.repr;
+	nat b, r(1, 1);
+	int i;
+
+	assert(!exponent.negative && "Negative exponent!");
+
+	b = nat_residue(base.repr, base.negative, mod);
+	r = nat_residue(r, false, mod);
+
+	for (i = nat_bit_length(e) - 1; i >= 0; i--) {
+		r = barrett_reduce(nat_mul(r, r), mod, mu);
+
+		if (nat_bit(e, i)) {
+			r = barrett_reduce(nat_mul(r, b), mod, mu);
+		}
+	}
+
+	return BigInt(r, false);
+}
+
+
+algo::bigint::Montgomery::Montgomery(const BigInt &modulus)
+: mod(modulus.repr)
+{
+	nat power, q;
+	int k;
+
+	assert(!mod.empty() && "Division by zero!");
+
+	k = mod.size();
+	n_inv = montgomery_inverse(mod[0]);
+
+	power.assign(k + 1, 0);
+	power.back() = 1;
+	nat_divrem(power, mod, q, one);
+	one.resize(k, 0);
+
+	power.assign(2 * k + 1, 0);
+	power.back() = 1;
+	nat_divrem(power, mod, q, r2);
+	r2.resize(k, 0);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::Montgomery::modpow(const BigInt &base, const BigInt &exponent)
+{
+	return multi_modpow(&base, &exponent, 1);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::Montgomery::multi_modpow(const BigInt *bases, const BigInt *exponents, int count)
+{
+	int k = mod.size();
+	int bits, w, i, j, d;
+	bool started;
+	nat t(2 * k + 1), acc(one), b, e, r;
+
+	std::vector<std::vector<int>> digits(count);
+	std::vector<nat> tables(count);
+
+	bits = 0;
+	for (i = 0; i < count; i++) {
+		assert(!exponents[i].negative && "Negative exponent!");
+
+		e = exponents[i].repr;
+		w = window_size(nat_bit_length(e));
+		window_digits(e, w, digits[i]);
+
+		if ((int)digits[i].size() > bits) {
+			bits = digits[i].size();
+		}
+
+		//odd powers g, g^3, ..., g^(2^w - 1) in Montgomery form
+		b = nat_residue(bases[i].repr, bases[i].negative, mod);
+		b.resize(k, 0);
+
+		nat &table = tables[i];
+		nat g2(k);
+
+		table.resize(k << (w - 1));
+		montgomery_mul(k, b.data(), r2.data(), mod.data(), n_inv, t.data(), table.data());
+		montgomery_mul(k, table.data(), table.data(), mod.data(), n_inv, t.data(), g2.data());
+
+		for (j = 1; j < (1 << (w - 1)); j++) {
+			montgomery_mul(k, table.data() + (j - 1) * k, g2.data(), mod.data(), n_inv,
+				t.data(), table.data() + j * k);
+		}
+	}
+
+	started = false;
+	for (j = bits - 1; j >= 0; j--) {
+		if (started) {
+			montgomery_mul(k, acc.data(), acc.data(), mod.data(), n_inv, t.data(), acc.data());
+		}
+
+		for (i = 0; i < count; i++) {
+			if (j >= (int)digits[i].size() || (d = digits[i][j]) == 0) {
+				continue;
+			}
+
+			const uint32_t *g = tables[i].data() + (d >> 1) * k;
+
+			if (started) {
+				montgomery_mul(k, acc.data(), g, mod.data(), n_inv, t.data(), acc.data());
+			} else {
+				std::copy(g, g + k, acc.begin());
+				started = true;
+			}
+		}
+	}
+
+	std::fill(t.begin(), t.end(), 0);
+	std::copy(acc.begin(), acc.end(), t.begin());
+	montgomery_redc(k, t.data(), mod.data(), n_inv);
+
+	r.assign(t.begin() + k, t.begin() + 2 * k);
+
+	return BigInt(r, false);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::modpow(const BigInt &base, const BigInt &exponent, const BigInt &modulus)
 {
-	uint16_t v[n * 2];
-	uint16_t k;
-	char *s, t;
-	int i;
+	assert(!modulus.repr.empty() && "Division by zero!");
 
-	u32_to_u16(n, u, v);
-	n *= 2;
+	if (modulus.repr[0] & 1) {
+		return Montgomery(modulus).modpow(base, exponent);
+	}
 
-	while (n && v[n - 1] == 0) n--;
+	return Reducer(modulus).modpow(base, exponent);
+}
 
-	if (n == 0) {
-		str[0] = '0';
-		str[1] = '\0';
-		return;
+
+#define LEHMER_BITS 62
+
+
+//bits of x from shift up, as many as fit in LEHMER_BITS
+static int64_t
+lehmer_digit(const nat &x, int shift)
+{
+	int i = shift / 32, s = shift % 32;
+	uint64_t lo = 0, hi = 0;
+
+	if (i < (int)x.size()) {
+		lo = x[i];
+	}
+	if (i + 1 < (int)x.size()) {
+		lo |= (uint64_t)x[i + 1] << 32;
+	}
+	if (i + 2 < (int)x.size()) {
+		hi = x[i + 2];
 	}
 
-	s = str;
-	while (n != 0) {
-		short_division(n, v, 10000, v, &k);
-		while (n && v[n - 1] == 0) {
-			n--;
-		}
+	if (s) {
+		lo = (lo >> s) | (hi << (64 - s));
+	}
 
-		for (i = 0; (n != 0 && i < 4) || k; i++) {
-			*s++ = '0' + (k % 10);
-			k /= 10;
-		}
+	return lo & (((uint64_t)1 << LEHMER_BITS) - 1);
+}
+
+
+static uint64_t
+nat_to_u64(const nat &x)
+{
+	uint64_t w = 0;
+
+	for (int i = (x.size() < 2 ? x.size() : 2); i-- > 0;) {
+		w = (w << 32) | x[i];
 	}
 
-	*s-- = '\0';
-	while (str < s) {
-		t = *str;
-		*str++ = *s;
-		*s-- = t;
+	return w;
+}
+
+
+#if !defined(ALGO_BIGINT_WORD64)
+//x * a + y * b for cofactors of opposite sign (or zero) whose combination
+//is known to be nonnegative
+static nat
+nat_combine(int64_t x, const nat &a, int64_t y, const nat &b)
+{
+	nat p = nat_mul(a, nat_u64(x < 0 ? -(uint64_t)x : x));
+	nat q = nat_mul(b, nat_u64(y < 0 ? -(uint64_t)y : y));
+
+	if (x >= 0 && y >= 0) {
+		return nat_add(p, q);
 	}
+
+	return x >= 0 ? nat_sub(p, q) : nat_sub(q, p);
 }
+#endif
 
 
-static algo::bigint::BigInt
-bigint_add(int x_len, const uint32_t *x, int y_len, const uint32_t *y)
+//(a, b) = (A * a + B * b, C * a + D * b) for the cofactors of a Lehmer
+//step, both combinations nonnegative
+static void
+lehmer_update(nat &a, nat &b, int64_t A, int64_t B, int64_t C, int64_t D)
 {
-	if (x_len < y_len) {
-		return bigint_add(y_len, y, x_len, x);
+#if defined(ALGO_BIGINT_WORD64)
+	__int128 s = 0, t = 0;
+	size_t i;
+
+	b.resize(a.size());
+
+	//a single pass in place, the signed carries shifted arithmetically
+	for (i = 0; i < a.size(); i++) {
+		s += (__int128)A * a[i] + (__int128)B * b[i];
+		t += (__int128)C * a[i] + (__int128)D * b[i];
+		a[i] = (uint32_t)s;
+		b[i] = (uint32_t)t;
+		s >>= 32;
+		t >>= 32;
 	}
 
-	int w_len = x_len + 1;
-	uint32_t w[w_len];
-	int i;
+	nat_trim(a);
+	nat_trim(b);
+#else
+	nat r = nat_combine(C, a, D, b);
 
-	assert(x_len >= y_len);
+	a = nat_combine(A, a, B, b);
+	b = std::move(r);
+#endif
+}
+
+
+//binary gcd on machine words
+static uint64_t
+gcd_u64(uint64_t a, uint64_t b)
+{
+	int k;
 
-	for (i = 0; i < y_len; i++) {
-		w[i] = y[i];
+	if (!a || !b) {
+		return a | b;
 	}
-	for (i = y_len; i < x_len; i++) {
-		w[i] = 0;
+
+	k = __builtin_ctzll(a | b);
+	a >>= __builtin_ctzll(a);
+
+	while (b) {
+		b >>= __builtin_ctzll(b);
+		if (a > b) {
+			std::swap(a, b);
+		}
+		b -= a;
 	}
 
-	algorithm_a(x_len, x, w, w);
+	return a << k;
+}
+
+
+//one step of Lehmer's algorithm on a >= b > 2^64: runs Euclid on the
+//leading LEHMER_BITS bits of both for as long as the quotients provably
+//match the true ones (Knuth's Algorithm L) and collects the cofactors,
+//so that (a, b) becomes (A * a + B * b, C * a + D * b). Returns false
+//when not even one quotient is certain and a full division is due.
+static bool
+lehmer_step(const nat &a, const nat &b, int64_t &A, int64_t &B, int64_t &C, int64_t &D)
+{
+	int shift = nat_bit_length(a) - LEHMER_BITS;
+	int64_t x = lehmer_digit(a, shift), y = lehmer_digit(b, shift);
+	int64_t q, t;
+
+	A = 1, B = 0, C = 0, D = 1;
+
+	while (y + C != 0 && y + D != 0) {
+		q = (x + A) / (y + C);
+		if (q != (x + B) / (y + D)) {
+			break;
+		}
+
+		t = A - q * C, A = C, C = t;
+		t = B - q * D, B = D, D = t;
+		t = x - q * y, x = y, y = t;
+	}
 
-	return algo::bigint::BigInt(std::vector<uint32_t>(w, w + w_len), false);
+	return B != 0;
 }
 
 
-static algo::bigint::BigInt
-bigint_sub(int x_len, const uint32_t *x, int y_len, const uint32_t *y)
+//gcd of the magnitudes; Lehmer steps while the operands are longer than
+//two limbs, then word-sized binary gcd
+static nat
+nat_gcd(nat a, nat b)
 {
-	if (bigint_cmp(x_len, x, y_len, y) < 0)
-		return algo::bigint::BigInt(bigint_sub(y_len, y, x_len, x).representation(), true);
+	int64_t A, B, C, D;
+	nat q, r;
 
-	uint32_t w[x_len];
-	int i;
+	if (nat_cmp(a, b) < 0) {
+		std::swap(a, b);
+	}
 
-	assert(x_len >= y_len);
+	while (b.size() > 2) {
+		if (lehmer_step(a, b, A, B, C, D)) {
+			lehmer_update(a, b, A, B, C, D);
+		} else {
+			nat_divrem(a, b, q, r);
+			a = std::move(b);
+			b = std::move(r);
+		}
+	}
 
-	for (i = 0; i < y_len; i++) {
-		w[i] = y[i];
+	if (b.empty()) {
+		return a;
 	}
-	for (i = y_len; i < x_len; i++) {
-		w[i] = 0;
+
+	if (a.size() > 2) {
+		nat_divrem(a, b, q, r);
+		a = std::move(r);
 	}
 
-	algorithm_s(x_len, x, w, w);
+	return nat_u64(gcd_u64(nat_to_u64(a), nat_to_u64(b)));
+}
+
 
-	return algo::bigint::BigInt(std::vector<uint32_t>(w, w + x_len), false);
+algo::bigint::BigInt
+algo::bigint::gcd(const BigInt &a, const BigInt &b)
+{
+	return BigInt(nat_gcd(a.limbs(), b.limbs()), false);
 }
 
 
-static algo::bigint::BigInt
-bigint_divrem(int x_len, const uint32_t *x, int y_len, const uint32_t *y, bool remainder)
+//(s, t) = (A * s + B * t, C * s + D * t) on cofactor magnitudes
+static void
+cofactor_update(nat &s, nat &t, uint64_t A, uint64_t B, uint64_t C, uint64_t D)
 {
-	uint32_t q[x_len - y_len + 1];
-	uint32_t r[y_len];
+#if defined(ALGO_BIGINT_WORD64)
+	uint128_t x = 0, y = 0;
+	size_t i, n = s.size() > t.size() ? s.size() : t.size();
 
-	assert(x_len >= y_len);
+	s.resize(n);
+	t.resize(n);
 
-	algorithm_d_wrapper(x_len - y_len, y_len, x, y, q, r);
+	for (i = 0; i < n; i++) {
+		x += (uint128_t)A * s[i] + (uint128_t)B * t[i];
+		y += (uint128_t)C * s[i] + (uint128_t)D * t[i];
+		s[i] = (uint32_t)x;
+		t[i] = (uint32_t)y;
+		x >>= 32;
+		y >>= 32;
+	}
 
-	if (remainder) {
-		return algo::bigint::BigInt(std::vector<uint32_t>(r, r + y_len), false);
+	while (x || y) {
+		s.push_back((uint32_t)x);
+		t.push_back((uint32_t)y);
+		x >>= 32;
+		y >>= 32;
 	}
 
-	return algo::bigint::BigInt(std::vector<uint32_t>(q, q + (x_len - y_len + 1)), false);
+	nat_trim(s);
+	nat_trim(t);
+#else
+	nat r = nat_add(nat_mul(s, nat_u64(C)), nat_mul(t, nat_u64(D)));
+
+	s = nat_add(nat_mul(s, nat_u64(A)), nat_mul(t, nat_u64(B)));
+	t = std::move(r);
+#endif
 }
 
 
-std::vector<uint32_t>
-algo::bigint::BigInt::from_string(const char *string)
+//Lehmer's algorithm tracking only the cofactor of a; the one of b follows
+//from the result with an exact division. The cofactors alternate in sign,
+//so only their magnitudes are kept along with the sign of s.
+algo::bigint::BigInt
+algo::bigint::xgcd(const BigInt &a, const BigInt &b, BigInt &x, BigInt &y)
 {
-	int n = std::strlen(string);
+	nat u = a.limbs(), v = b.limbs(), s = nat_u64(1), t, q, r;
+	int64_t A, B, C, D;
+	bool negative = false;
+
+	//u = ±s * |a| and v = ∓t * |a| modulo |b| throughout
+	if (nat_cmp(u, v) < 0) {
+		std::swap(u, v);
+		std::swap(s, t);
+		negative = true;
+	}
 
-	uint32_t u[n / 9 + 1];
-	negative = false;
-	int u_length;
+	while (!v.empty() && u.size() > 2) {
+		if (v.size() > 2 && lehmer_step(u, v, A, B, C, D)) {
+			lehmer_update(u, v, A, B, C, D);
+			cofactor_update(s, t, A < 0 ? -(uint64_t)A : A, B < 0 ? -(uint64_t)B : B,
+				C < 0 ? -(uint64_t)C : C, D < 0 ? -(uint64_t)D : D);
+
+			//D has the sign of (-1)^steps
+			negative ^= (D < 0);
+		} else {
+			nat_divrem(u, v, q, r);
+			u = std::move(v);
+			v = std::move(r);
+
+			r = nat_add(s, nat_mul(q, t));
+			s = std::move(t);
+			t = std::move(r);
+			negative = !negative;
+		}
+	}
 
-	assert(n > 0 && "Empty string is not a valid number.");
+	//both fit in words now, unless v is already zero
+	nat g = u;
+	uint64_t m = nat_to_u64(u), n = nat_to_u64(v), k;
 
-	if (string[0] == '-') {
-		assert(n > 1 && "Just '-' is not a valid number.");
-		negative = true;
-		string++;
-		n--;
+	if (n) {
+		while (n) {
+			k = m / n;
+			std::swap(m, n);
+			n -= k * m;
+
+			r = nat_add(s, nat_mul(nat_u64(k), t));
+			s = std::move(t);
+			t = std::move(r);
+			negative = !negative;
+		}
+
+		g = nat_u64(m);
 	}
 
-	bigint_from_string(n, string, &u_length, u);
+	x = BigInt(s, negative != a.is_negative());
+	y = b.limbs().empty() ? BigInt() : (BigInt(g, false) - a * x) / b;
 
-	return std::vector<uint32_t>(u, u + u_length);
+	return BigInt(g, false);
 }
 
 
-std::string
-algo::bigint::BigInt::to_string()
+algo::bigint::BigInt
+algo::bigint::modinv(const BigInt &a, const BigInt &m)
 {
-	char buff[repr.size() + 1];
+	BigInt x, y;
+
+	assert(!m.is_negative() && !m.limbs().empty() && "Modulus must be positive!");
+	BigInt g = xgcd(a % m, m, x, y);
+
+	assert(g.bit_length() == 1 && "Not invertible!");
+
+	x %= m;
+	return x.is_negative() ? x + m : x;
+}
+
 
-	uint32_t arr[repr.size()];
 
-	for (int i = 0; i < repr.size(); i++) {
-		arr[i] = repr[i];
+algo::bigint::BigInt
+algo::bigint::square(const BigInt &x)
+{
+	const nat &u = x.limbs();
+	nat w(2 * u.size());
+
+	if (u.empty()) {
+		return BigInt();
 	}
 
-	if (negative && repr.size() > 0 && repr[0] != 0) {
-		buff[0] = '-';
-		bigint_to_string(repr.size(), arr, buff + 1);
-	} else {
-		bigint_to_string(repr.size(), arr, buff);
+	multiply(u.size(), u.size(), u.data(), u.data(), w.data());
+
+	return BigInt(std::move(w), false);
+}
+
+//left-to-right binary powering over the magnitude
+static nat
+nat_pow(const nat &x, uint64_t e)
+{
+	nat w;
+	int i;
+
+	if (e == 0) {
+		return nat_u64(1);
 	}
 
-	return std::string(buff);
+	w = x;
+	for (i = 62 - __builtin_clzll(e); i >= 0; i--) {
+		w = nat_mul(w, w);
+		if ((e >> i) & 1) {
+			w = nat_mul(w, x);
+		}
+	}
+
+	return w;
 }
 
 
 algo::bigint::BigInt
-algo::bigint::BigInt::operator+(const BigInt &op)
+algo::bigint::pow(const BigInt &base, uint64_t exponent)
+{
+	size_t zeros = base.trailing_zeros(), bits;
+	nat w;
+
+	if (base.repr.empty()) {
+		return exponent ? BigInt() : BigInt(nat_u64(1), false);
+	}
+
+	//the result has fewer than bits * exponent + 1 bits, bits counting
+	//the power of two and the odd part above its lowest bit. Divided,
+	//not multiplied, so a huge exponent cannot wrap past the check.
+	bits = nat_bit_length(base.repr) - 1;
+	assert((bits == 0 || exponent < (1U << 31) / bits) && "Result too large!");
+
+	//the power of two in the base becomes one shift at the end
+
+	w = nat_pow(nat_shift_right(base.repr, zeros), exponent);
+	w = nat_shift_left(w, zeros * exponent);
+
+	return BigInt(std::move(w), base.negative && (exponent & 1));
+}
+
+
+static uint64_t
+isqrt_u64(uint64_t n)
 {
-	uint32_t x[repr.size()];
-	uint32_t y[op.repr.size()];
+	uint64_t r = (uint64_t)std::sqrt((double)n);
 
-	for (int i = 0; i < op.repr.size(); i++) {
-		y[i] = op.repr[i];
+	//the double may be off by one either way
+	if (r > 0xffffffff) {
+		r = 0xffffffff;
+	}
+	while (r * r > n) {
+		r--;
 	}
+	while (r < 0xffffffff && (r + 1) * (r + 1) <= n) {
+		r++;
+	}
+
+	return r;
+}
+
+
+//floor root from above by Newton's iteration, x = (x + n / x) / 2 until it
+//stops decreasing. The start is the root of the leading half of n, so it
+//already has half the bits right and a step or two finishes; the recursion
+//halves the length each level, so the total is a few full divisions.
+static nat
+nat_isqrt(const nat &n)
+{
+	int k = nat_bit_length(n) / 4;
+	nat x, y, q, r;
 
-	for (int i = 0; i < repr.size(); i++) {
-		x[i] = repr[i];
+	if (n.size() <= 2) {
+		return nat_u64(isqrt_u64(nat_to_u64(n)));
 	}
 
-	if (negative && op.negative) {
-		return algo::bigint::BigInt(bigint_add(repr.size(), x, op.repr.size(), y).representation(), true);
+	x = nat_isqrt(nat_shift_right(n, 2 * k));
+	x = nat_shift_left(nat_add(x, nat_u64(1)), k);
+
+	for (;;) {
+		nat_divrem(n, x, q, r);
+		y = nat_shift_right(nat_add(x, q), 1);
+
+		if (nat_cmp(y, x) >= 0) {
+			return x;
+		}
+		x = std::move(y);
 	}
+}
 
-	if (negative) {
-		assert(!op.negative);
-		return bigint_sub( op.repr.size(), y, repr.size(), x);
+
+//the same for k-th roots, x = ((k - 1) * x + n / x^(k - 1)) / k; roots of
+//up to 32 bits are found bit by bit instead
+static nat
+nat_iroot(const nat &n, int k)
+{
+	int bits = nat_bit_length(n), s = bits / (2 * k), i;
+	uint64_t c, root = 0;
+	nat x, y, q, r;
+
+	if ((bits - 1) / k < 32) {
+		for (i = (bits - 1) / k; i >= 0; i--) {
+			c = root | (uint64_t)1 << i;
+			if (nat_cmp(nat_pow(nat_u64(c), k), n) <= 0) {
+				root = c;
+			}
+		}
+
+		return nat_u64(root);
 	}
 
-	if (op.negative) {
-		assert(!negative);
-		return bigint_sub(repr.size(), x, op.repr.size(), y);
+	x = nat_iroot(nat_shift_right(n, k * s), k);
+	x = nat_shift_left(nat_add(x, nat_u64(1)), s);
+
+	for (;;) {
+		nat_divrem(n, nat_pow(x, k - 1), q, r);
+		nat_divrem(nat_add(nat_mul(x, nat_u64(k - 1)), q), nat_u64(k), y, r);
+
+		if (nat_cmp(y, x) >= 0) {
+			return x;
+		}
+		x = std::move(y);
 	}
+}
 
-	assert(!negative && !op.negative);
 
-	return bigint_add(repr.size(), x, op.repr.size(), y);
+algo::bigint::BigInt
+algo::bigint::isqrt(const BigInt &n)
+{
+	assert(!n.is_negative() && "Square root of a negative number!");
+
+	return BigInt(nat_isqrt(n.limbs()), false);
 }
 
 
 algo::bigint::BigInt
-algo::bigint::BigInt::operator-(const BigInt &op)
+algo::bigint::iroot(const BigInt &n, uint64_t k)
 {
-	uint32_t x[repr.size()];
-	uint32_t y[op.repr.size()];
+	size_t bits = n.bit_length();
+
+	assert(k > 0 && "Zeroth root!");
+	assert((!n.is_negative() || (k & 1)) && "Even root of a negative number!");
+
+	if (k == 1) {
+		return n;
+	}
+	if (k == 2) {
+		return isqrt(n);
+	}
+
+	//the root of anything shorter than k bits is 0 or 1
+	if (k >= bits) {
+		return BigInt(nat_u64(bits > 0), n.is_negative());
+	}
+
+	return BigInt(nat_iroot(n.limbs(), k), n.is_negative());
+}
+
+
+
+#define DECIMAL_BLOCK_LEVEL 8
+#define DECIMAL_BLOCK (9 << DECIMAL_BLOCK_LEVEL)
+#define STREAM_CHUNK (1 << 16)
 
-	for (int i = 0; i < op.repr.size(); i++) {
-		y[i] = op.repr[i];
+
+//decimal digits fed in pieces of any length. Every DECIMAL_BLOCK digits
+//become one value of level DECIMAL_BLOCK_LEVEL, and two values of the
+//same level merge into one of the next, hi * 10^(9 * 2^level) + lo, like
+//a binary counter; the products stay balanced as in nat_from_decimal,
+//and only the current block is ever kept as text.
+class decimal_reader {
+public:
+	decimal_reader()
+	: digits(0)
+	{
+		block.reserve(DECIMAL_BLOCK);
 	}
 
-	for (int i = 0; i < repr.size(); i++) {
-		x[i] = repr[i];
+	size_t
+	count() const
+	{
+		return digits;
 	}
 
-	if (negative && op.negative) {
-		return bigint_sub(op.repr.size(), y, repr.size(), x);
+	void
+	push(const char *str, size_t n)
+	{
+		size_t take;
+
+		digits += n;
+
+		while (n > 0) {
+			take = DECIMAL_BLOCK - block.size();
+			if (take > n) {
+				take = n;
+			}
+
+			block.append(str, take);
+			str += take;
+			n -= take;
+
+			if (block.size() == DECIMAL_BLOCK) {
+				merge(nat_from_decimal(block.data(), DECIMAL_BLOCK), DECIMAL_BLOCK_LEVEL);
+				block.clear();
+			}
+		}
 	}
 
-	if (negative) {
-		assert(!op.negative);
-		return algo::bigint::BigInt(bigint_add(repr.size(), x, op.repr.size(), y).representation(), true);
+	//the levels decrease from the bottom of the stack, so the values fold
+	//from there, the partial block last
+	nat
+	finish()
+	{
+		nat w;
+		size_t i;
+
+		assert(digits > 0 && "Empty string is not a valid number.");
+
+		for (i = 0; i < levels.size(); i++) {
+			w = nat_add(nat_mul(w, decimal_power(levels[i].second)), levels[i].first);
+		}
+
+		if (!block.empty()) {
+			w = nat_mul(w, nat_pow(nat_u64(10), block.size()));
+			w = nat_add(w, nat_from_decimal(block.data(), block.size()));
+		}
+
+		return w;
 	}
 
-	if (op.negative) {
-		assert(!negative);
-		return bigint_add(repr.size(), x, op.repr.size(), y);
+private:
+	std::string block;
+	std::vector<std::pair<nat, int>> levels;
+	size_t digits;
+
+	void
+	merge(nat value, int level)
+	{
+		while (!levels.empty() && levels.back().second == level) {
+			value = nat_add(nat_mul(levels.back().first, decimal_power(level)), value);
+			levels.pop_back();
+			level++;
+		}
+
+		levels.emplace_back(std::move(value), level);
 	}
+};
 
-	assert(!negative && !op.negative);
 
-	return bigint_sub(repr.size(), x, op.repr.size(), y);
+static bool
+is_space(char c)
+{
+	return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
 }
 
 
 algo::bigint::BigInt
-algo::bigint::BigInt::operator*(const BigInt &op)
+algo::bigint::read_decimal(const ByteSource &source)
 {
-	uint32_t x[repr.size()];
-	uint32_t y[op.repr.size()];
+	std::vector<char> buffer(STREAM_CHUNK);
+	decimal_reader reader;
+	bool negative = false, done = false;
+	size_t n, i, j;
+
+	while ((n = source(buffer.data(), buffer.size())) > 0) {
+		for (i = 0; i < n; i = j) {
+			for (j = i; j < n && buffer[j] >= '0' && buffer[j] <= '9'; j++);
+
+			if (j > i) {
+				assert(!done && "Invalid character in number!");
+				reader.push(buffer.data() + i, j - i);
+				continue;
+			}
 
-	for (int i = 0; i < op.repr.size(); i++) {
-		y[i] = op.repr[i];
+			//a sign right before the first digit, space around the number
+			if (buffer[i] == '-' && !negative && reader.count() == 0) {
+				negative = true;
+			} else {
+				assert(is_space(buffer[i]) && "Invalid character in number!");
+				assert((reader.count() > 0 || !negative) && "Just '-' is not a valid number.");
+				done = reader.count() > 0;
+			}
+			j = i + 1;
+		}
 	}
 
-	for (int i = 0; i < repr.size(); i++) {
-		x[i] = repr[i];
-	}
+	return BigInt(reader.finish(), negative);
+}
+
 
-	uint32_t w[repr.size() + op.repr.size()];
+algo::bigint::BigInt
+algo::bigint::read_decimal(int fd)
+{
+	return read_decimal([fd](char *buffer, size_t size) {
+		ssize_t n;
 
-	algorithm_m(repr.size(), op.repr.size(), x, y, w);
+		while ((n = ::read(fd, buffer, size)) < 0 && errno == EINTR);
+		assert(n >= 0 && "Read failed!");
 
-	return algo::bigint::BigInt(
-		std::vector<uint32_t>(w, w + (repr.size() + op.repr.size())),
-		negative ^ op.negative
-	);
+		return (size_t)n;
+	});
 }
 
 
-algo::bigint::BigInt
-algo::bigint::BigInt::operator/(const BigInt &op)
+void
+algo::bigint::write_decimal(const BigInt &x, const ByteSink &sink)
 {
-	uint32_t x[repr.size()];
-	uint32_t y[op.repr.size()];
+	decimal_out out = { std::string(), &sink };
 
-	for (int i = 0; i < op.repr.size(); i++) {
-		y[i] = op.repr[i];
+	if (x.is_negative()) {
+		out.text.push_back('-');
 	}
 
-	for (int i = 0; i < repr.size(); i++) {
-		x[i] = repr[i];
-	}
+	nat_to_decimal(x.limbs(), decimal_level(x.limbs()), false, out);
 
-	if (repr.size() < op.repr.size()) {
-		return algo::bigint::BigInt(std::vector<uint32_t>(), false);
+	if (!out.text.empty()) {
+		sink(out.text.data(), out.text.size());
 	}
-
-	return algo::bigint::BigInt(
-		bigint_divrem(repr.size(), x, op.repr.size(), y, false).representation(),
-		negative ^ op.negative
-	);
 }
 
 
-algo::bigint::BigInt
-algo::bigint::BigInt::operator%(const BigInt &op)
+//like the built-in integers: leading space skipped, then an optional '-'
+//and digits up to the first other character, which is left in the stream
+std::istream &
+algo::bigint::operator>>(std::istream &in, BigInt &x)
 {
-	uint32_t x[repr.size()];
-	uint32_t y[op.repr.size()];
+	typedef std::char_traits<char> traits;
+
+	std::istream::sentry sentry(in);
+	std::streambuf *buf = in.rdbuf();
+	decimal_reader reader;
+	char piece[256];
+	bool negative = false;
+	size_t n = 0;
+	int c;
+
+	if (!sentry) {
+		return in;
+	}
+
+	c = buf->sgetc();
+	if (c == '-') {
+		negative = true;
+		c = buf->snextc();
+	}
 
-	for (int i = 0; i < op.repr.size(); i++) {
-		y[i] = op.repr[i];
+	for (; c != traits::eof() && c >= '0' && c <= '9'; c = buf->snextc()) {
+		piece[n++] = c;
+		if (n == sizeof(piece)) {
+			reader.push(piece, n);
+			n = 0;
+		}
 	}
+	reader.push(piece, n);
 
-	for (int i = 0; i < repr.size(); i++) {
-		x[i] = repr[i];
+	if (c == traits::eof()) {
+		in.setstate(std::ios::eofbit);
 	}
 
-	if (repr.size() < op.repr.size()) {
-		return algo::bigint::BigInt(repr, negative);
-	} else {
-		return algo::bigint::BigInt(
-			bigint_divrem(repr.size(), x, op.repr.size(), y, true).representation(),
-			negative
-		);
+	if (reader.count() == 0) {
+		in.setstate(std::ios::failbit);
+		return in;
 	}
+
+	x = BigInt(reader.finish(), negative);
+
+	return in;
 }
 
 
-bool
-algo::bigint::BigInt::operator==(const BigInt &op)
+std::ostream &
+algo::bigint::operator<<(std::ostream &out, const BigInt &x)
 {
-	uint32_t x[repr.size()];
-	uint32_t y[op.repr.size()];
+	write_decimal(x, [&out](const char *data, size_t size) {
+		out.write(data, size);
+	});
 
-	for (int i = 0; i < op.repr.size(); i++) {
-		y[i] = op.repr[i];
-	}
+	return out;
+}
+
+algo::bigint::BigIntView::BigIntView(const uint32_t *limbs, int size, bool negative)
+: limbs(limbs), len(trimmed_length(size, limbs)), negative(negative && len > 0)
+{}
+
+
+algo::bigint::BigInt::BigInt(const BigIntView &view)
+: repr(view.data(), view.data() + view.size()), negative(view.is_negative())
+{
+	normalize();
+}
 
-	for (int i = 0; i < repr.size(); i++) {
-		x[i] = repr[i];
+
+//u + (-1)^v_neg * |v| straight from the views' limbs
+static algo::bigint::BigInt
+view_sum(const algo::bigint::BigIntView &u, const algo::bigint::BigIntView &v, bool v_neg)
+{
+	const uint32_t *a = u.data(), *b = v.data();
+	int m = u.size(), n = v.size();
+	bool neg = u.is_negative();
+	nat w;
+
+	//put the larger magnitude first
+	if (m < n || (neg != v_neg && bigint_cmp(m, a, n, b) < 0)) {
+		std::swap(a, b);
+		std::swap(m, n);
+		neg = v_neg;
 	}
 
-	if (negative != op.negative) {
-		return false;
+	w.assign(a, a + m);
+
+	if (u.is_negative() == v_neg) {
+		w.push_back(0);
+		add_into(w.size(), w.data(), n, b);
+	} else {
+		sub_from(m, w.data(), n, b);
 	}
 
-	if (negative) {
-		return bigint_cmp(op.repr.size(), y, repr.size(), x) == 0;
+	return algo::bigint::BigInt(std::move(w), neg);
+}
+
+
+algo::bigint::BigInt
+algo::bigint::operator+(const BigIntView &u, const BigIntView &v)
+{
+	return view_sum(u, v, v.is_negative());
+}
+
+
+algo::bigint::BigInt
+algo::bigint::operator-(const BigIntView &u, const BigIntView &v)
+{
+	return view_sum(u, v, v.size() > 0 && !v.is_negative());
+}
+
+
+algo::bigint::BigInt
+algo::bigint::operator*(const BigIntView &u, const BigIntView &v)
+{
+	nat w;
+
+	if (u.size() == 0 || v.size() == 0) {
+		return BigInt();
 	}
 
-	return bigint_cmp(repr.size(), x, op.repr.size(), y) == 0;
+	w.resize(u.size() + v.size());
+	multiply(u.size(), v.size(), u.data(), v.data(), w.data());
+
+	return BigInt(std::move(w), u.is_negative() ^ v.is_negative());
 }
 
 
-bool
-algo::bigint::BigInt::operator!=(const BigInt &op)
+algo::bigint::BigInt
+algo::bigint::operator/(const BigIntView &u, const BigIntView &v)
 {
-	return !(*this == op);
+	nat q, r;
+
+	assert(v.size() > 0 && "Division by zero!");
+
+	divrem_words(u.size(), u.data(), v.size(), v.data(), q, r);
+
+	return BigInt(std::move(q), u.is_negative() ^ v.is_negative());
+}
+
+
+algo::bigint::BigInt
+algo::bigint::operator%(const BigIntView &u, const BigIntView &v)
+{
+	nat q, r;
+
+	assert(v.size() > 0 && "Division by zero!");
+
+	divrem_words(u.size(), u.data(), v.size(), v.data(), q, r);
+
+	return BigInt(std::move(r), u.is_negative());
+}
+
+
+int
+algo::bigint::compare(const BigIntView &u, const BigIntView &v)
+{
+	int sign = u.is_negative() ? -1 : 1;
+
+	if (u.is_negative() != v.is_negative()) {
+		return sign;
+	}
+
+	return sign * bigint_cmp(u.size(), u.data(), v.size(), v.data());
 }
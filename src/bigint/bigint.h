@@ -5,76 +5,497 @@
 #include <vector>
 #include <cstdint>
 #include <string>
+#include <utility>
+#include <functional>
+#include <iosfwd>
+#include <type_traits>
+
+#include "limbs.h"
 
 
 namespace algo::bigint
 {
+	class Reducer;
+	class Montgomery;
+	class BigIntView;
+
+
+	//bool and the character types, which would otherwise turn 'a' into 97;
+	//signed and unsigned char stay integers as int8_t and uint8_t
+	template <typename T>
+	using is_excluded_integral = std::integral_constant<bool,
+		std::is_same<T, bool>::value || std::is_same<T, char>::value
+		|| std::is_same<T, wchar_t>::value || std::is_same<T, char16_t>::value
+		|| std::is_same<T, char32_t>::value
+#if defined(__cpp_char8_t)
+		|| std::is_same<T, char8_t>::value
+#endif
+		>;
+
+	//enables the scalar overloads for the other built-in integer types
+	template <typename T>
+	using if_integral = typename std::enable_if<std::is_integral<T>::value && !is_excluded_integral<T>::value, int>::type;
+
+
 	class BigInt {
 	public:
 		BigInt(std::string &string)
 		: repr(from_string(string))
-		{}
+		{
+			normalize();
+		}
 
 		BigInt(const char *c_string)
 		: repr(from_string(c_string))
-		{}
+		{
+			normalize();
+		}
 
 		BigInt(char *c_string)
 		: repr(from_string(c_string))
-		{}
+		{
+			normalize();
+		}
 
 		BigInt(const std::vector<uint32_t> &array, bool negative)
 		: repr(array), negative(negative)
-		{}
+		{
+			normalize();
+		}
+
+		BigInt(const Limbs &array, bool negative)
+		: repr(array), negative(negative)
+		{
+			normalize();
+		}
+
+		BigInt(Limbs &&array, bool negative)
+		: repr(std::move(array)), negative(negative)
+		{
+			normalize();
+		}
 
 		BigInt()
+		: negative(false), bits(0)
 		{}
 
-		BigInt operator+(const BigInt &op);
-		BigInt operator-(const BigInt &op);
-		BigInt operator*(const BigInt &op);
-		BigInt operator/(const BigInt &op);
-		BigInt operator%(const BigInt &op);
+		//any built-in integer but bool and the character types, int64_t
+		//and uint64_t included
+		template <typename T, if_integral<T> = 0>
+		BigInt(T value)
+		: negative(value < 0)
+		{
+			uint64_t magnitude = value < 0 ? -(uint64_t)value : (uint64_t)value;
+
+			repr.push_back((uint32_t)magnitude);
+			repr.push_back((uint32_t)(magnitude >> 32));
+			normalize();
+		}
+
+		explicit BigInt(const BigIntView &view);
 
-		bool operator==(const BigInt &op);
-		bool operator!=(const BigInt &op);
+		//magnitude from len bytes, most significant first when big_endian
+		static BigInt from_bytes(const uint8_t *bytes, int len, bool big_endian = true, bool negative = false);
 
+		//hex digits in either case, with an optional '-' and "0x" prefix
+		static BigInt from_hex(const char *hex);
 
-		std::string to_string();
+		BigInt &operator+=(const BigInt &op);
+		BigInt &operator-=(const BigInt &op);
+		BigInt &operator*=(const BigInt &op);
+		BigInt &operator/=(const BigInt &op);
+		BigInt &operator%=(const BigInt &op);
+
+		//native integer operands go through single-limb kernels in O(n)
+		//and, like the BigInt forms, / truncates and % takes this sign
+		template <typename T, if_integral<T> = 0>
+		BigInt &
+		operator+=(T op)
+		{
+			return add_word(op < 0 ? -(uint64_t)op : (uint64_t)op, op < 0);
+		}
+
+		template <typename T, if_integral<T> = 0>
+		BigInt &
+		operator-=(T op)
+		{
+			return add_word(op < 0 ? -(uint64_t)op : (uint64_t)op, !(op < 0));
+		}
+
+		template <typename T, if_integral<T> = 0>
+		BigInt &
+		operator*=(T op)
+		{
+			return mul_word(op < 0 ? -(uint64_t)op : (uint64_t)op, op < 0);
+		}
+
+		template <typename T, if_integral<T> = 0>
+		BigInt &
+		operator/=(T op)
+		{
+			return div_word(op < 0 ? -(uint64_t)op : (uint64_t)op, op < 0, false);
+		}
+
+		template <typename T, if_integral<T> = 0>
+		BigInt &
+		operator%=(T op)
+		{
+			return div_word(op < 0 ? -(uint64_t)op : (uint64_t)op, op < 0, true);
+		}
+
+		//this += u * v and this -= u * v in this number's own buffer. Below
+		//the Karatsuba size the product's rows accumulate straight into it,
+		//above it the product comes from the per-thread workspace, so a
+		//chain of them allocates nothing once the buffer has grown. A
+		//native v converts without allocating.
+		BigInt &addmul(const BigInt &u, const BigInt &v);
+		BigInt &submul(const BigInt &u, const BigInt &v);
+
+		//the rvalue overloads compute in the left operand's buffer
+		BigInt operator+(const BigInt &op) const &;
+		BigInt operator+(const BigInt &op) &&;
+		BigInt operator-(const BigInt &op) const &;
+		BigInt operator-(const BigInt &op) &&;
+		BigInt operator*(const BigInt &op) const &;
+		BigInt operator*(const BigInt &op) &&;
+		BigInt operator/(const BigInt &op) const &;
+		BigInt operator/(const BigInt &op) &&;
+		BigInt operator%(const BigInt &op) const &;
+		BigInt operator%(const BigInt &op) &&;
+
+		//bitwise operators act on the infinite two's complement form, so
+		//>> rounds toward negative infinity and ~x is -x - 1
+		BigInt &operator<<=(size_t shift);
+		BigInt &operator>>=(size_t shift);
+		BigInt &operator&=(const BigInt &op);
+		BigInt &operator|=(const BigInt &op);
+		BigInt &operator^=(const BigInt &op);
+
+		BigInt operator<<(size_t shift) const &;
+		BigInt operator<<(size_t shift) &&;
+		BigInt operator>>(size_t shift) const &;
+		BigInt operator>>(size_t shift) &&;
+		BigInt operator&(const BigInt &op) const &;
+		BigInt operator&(const BigInt &op) &&;
+		BigInt operator|(const BigInt &op) const &;
+		BigInt operator|(const BigInt &op) &&;
+		BigInt operator^(const BigInt &op) const &;
+		BigInt operator^(const BigInt &op) &&;
+		BigInt operator~() const;
+
+		//set bits and trailing zeros of the magnitude, 0 for zero
+		size_t popcount() const;
+		size_t trailing_zeros() const;
+
+		//bit i of the two's complement form
+		bool test_bit(size_t i) const;
+		void set_bit(size_t i, bool value = true);
+
+		bool operator==(const BigInt &op) const;
+		bool operator!=(const BigInt &op) const;
+
+		//-1, 0 or 1 as this is below, equal to or above op
+		int compare(const BigInt &op) const;
+
+		bool operator<(const BigInt &op) const;
+		bool operator<=(const BigInt &op) const;
+		bool operator>(const BigInt &op) const;
+		bool operator>=(const BigInt &op) const;
+
+
+		std::string to_string() const;
+
+		//lowercase hex digits without a prefix, "-" for negatives
+		std::string to_hex() const;
+
+		//the magnitude's (bit_length() + 7) / 8 bytes; the pointer form
+		//zero-pads to exactly len bytes, which must be enough
+		std::vector<uint8_t> to_bytes(bool big_endian = true) const;
+		void to_bytes(uint8_t *bytes, int len, bool big_endian = true) const;
 
 		bool
-		is_empty()
+		is_empty() const
 		{
 			return repr.size() == 0;
 		}
 
 
 		bool
-		is_negative()
+		is_negative() const
 		{
 			return negative;
 		}
 
+
+		//bits in the magnitude, 0 for zero
+		size_t
+		bit_length() const
+		{
+			return bits;
+		}
+
 		const std::vector<uint32_t>
-		representation()
+		representation() const
+		{
+			return repr.to_vector();
+		}
+
+		const Limbs &
+		limbs() const
 		{
 			return repr;
 		}
 
 
 	private:
-		std::vector<uint32_t> repr;
+		friend class Reducer;
+		friend class Montgomery;
+		friend BigInt modpow(const BigInt &base, const BigInt &exponent, const BigInt &modulus);
+		friend BigInt pow(const BigInt &base, uint64_t exponent);
+
+		//repr never has high zero limbs, zero is empty and never negative,
+		//and bits caches the magnitude's bit length; normalize() restores
+		//all three after repr changes
+		Limbs repr;
 		bool negative;
+		size_t bits;
+
+		void normalize();
 
-		std::vector<uint32_t> from_string(const char *c_string);
+		BigInt &add_word(uint64_t op, bool op_negative);
+		BigInt &mul_word(uint64_t op, bool op_negative);
+		BigInt &div_word(uint64_t op, bool op_negative, bool remainder);
 
-		std::vector<uint32_t>
+		Limbs from_string(const char *c_string);
+
+		Limbs
 		from_string(std::string &string)
 		{
 			return from_string(string.c_str());
 		}
 	};
+
+
+	//chunked byte streams: a source fills up to size bytes and returns how
+	//many, 0 at the end; a sink takes each piece in order
+	typedef std::function<size_t(char *buffer, size_t size)> ByteSource;
+	typedef std::function<void(const char *data, size_t size)> ByteSink;
+
+	//decimal text of any length read and written in pieces: the text is
+	//never held whole, so beside a fixed buffer the memory is that of the
+	//binary number and its conversion. The readers take an optional '-'
+	//and the digits, with white space allowed around them.
+	BigInt read_decimal(const ByteSource &source);
+	BigInt read_decimal(int fd);
+	void write_decimal(const BigInt &x, const ByteSink &sink);
+
+	//stream forms; >> stops before the first character that is not a
+	//digit and sets failbit when there is none
+	std::istream &operator>>(std::istream &in, BigInt &x);
+	std::ostream &operator<<(std::ostream &out, const BigInt &x);
+
+
+	//binary forms of the scalar operators; x is taken by value, so an
+	//rvalue is reused and an lvalue copied once. With the scalar on the
+	//left, - / and % build a BigInt from it.
+	template <typename T, if_integral<T> = 0>
+	BigInt
+	operator+(BigInt x, T op)
+	{
+		x += op;
+		return x;
+	}
+
+	template <typename T, if_integral<T> = 0>
+	BigInt
+	operator+(T op, BigInt x)
+	{
+		x += op;
+		return x;
+	}
+
+	template <typename T, if_integral<T> = 0>
+	BigInt
+	operator-(BigInt x, T op)
+	{
+		x -= op;
+		return x;
+	}
+
+	template <typename T, if_integral<T> = 0>
+	BigInt
+	operator-(T op, const BigInt &x)
+	{
+		return BigInt(op) - x;
+	}
+
+	template <typename T, if_integral<T> = 0>
+	BigInt
+	operator*(BigInt x, T op)
+	{
+		x *= op;
+		return x;
+	}
+
+	template <typename T, if_integral<T> = 0>
+	BigInt
+	operator*(T op, BigInt x)
+	{
+		x *= op;
+		return x;
+	}
+
+	template <typename T, if_integral<T> = 0>
+	BigInt
+	operator/(BigInt x, T op)
+	{
+		x /= op;
+		return x;
+	}
+
+	template <typename T, if_integral<T> = 0>
+	BigInt
+	operator/(T op, const BigInt &x)
+	{
+		return BigInt(op) / x;
+	}
+
+	template <typename T, if_integral<T> = 0>
+	BigInt
+	operator%(BigInt x, T op)
+	{
+		x %= op;
+		return x;
+	}
+
+	template <typename T, if_integral<T> = 0>
+	BigInt
+	operator%(T op, const BigInt &x)
+	{
+		return BigInt(op) % x;
+	}
+
+
+	//non-owning view of little-endian limbs kept elsewhere, such as in a
+	//mapped file; the limbs must outlive it. High zero limbs are skipped
+	//when the view is made, and the free operators below read the limbs
+	//in place; / and % copy only the shifted limbs that division
+	//normalizes.
+	class BigIntView {
+	public:
+		BigIntView(const uint32_t *limbs, int size, bool negative = false);
+
+		BigIntView(const BigInt &value)
+		: BigIntView(value.limbs().data(), value.limbs().size(), value.is_negative())
+		{}
+
+		const uint32_t *
+		data() const
+		{
+			return limbs;
+		}
+
+		int
+		size() const
+		{
+			return len;
+		}
+
+		bool
+		is_negative() const
+		{
+			return negative;
+		}
+
+	private:
+		const uint32_t *limbs;
+		int len;
+		bool negative;
+	};
+
+
+	BigInt operator+(const BigIntView &u, const BigIntView &v);
+	BigInt operator-(const BigIntView &u, const BigIntView &v);
+	BigInt operator*(const BigIntView &u, const BigIntView &v);
+	BigInt operator/(const BigIntView &u, const BigIntView &v);
+	BigInt operator%(const BigIntView &u, const BigIntView &v);
+
+	//-1, 0 or 1 like BigInt::compare
+	int compare(const BigIntView &u, const BigIntView &v);
+
+
+	//Barrett reduction against a fixed modulus, for reducing many values
+	//modulo the same number. Results match BigInt::operator%.
+	class Reducer {
+	public:
+		Reducer(const BigInt &modulus);
+
+		BigInt reduce(const BigInt &value);
+		void reduce(BigInt *values, int count);
+
+		BigInt modpow(const BigInt &base, const BigInt &exponent);
+
+	private:
+		Limbs mod;
+		Limbs mu;
+	};
+
+
+	//Montgomery form arithmetic modulo an odd number. modpow uses sliding
+	//windows, multi_modpow computes the product of several powers with a
+	//single shared chain of squarings.
+	class Montgomery {
+	public:
+		Montgomery(const BigInt &modulus);
+
+		BigInt modpow(const BigInt &base, const BigInt &exponent);
+		BigInt multi_modpow(const BigInt *bases, const BigInt *exponents, int count);
+
+	private:
+		Limbs mod;
+		Limbs r2;
+		Limbs one;
+		uint32_t n_inv;
+	};
+
+
+	//base^exponent mod modulus, through Montgomery for odd moduli and
+	//Barrett reduction otherwise
+	BigInt modpow(const BigInt &base, const BigInt &exponent, const BigInt &modulus);
+
+
+	//greatest common divisor, never negative, by Lehmer's algorithm with
+	//double-digit quotient simulation and a binary gcd on the last words
+	BigInt gcd(const BigInt &a, const BigInt &b);
+
+	//g = gcd(a, b) together with x, y such that a * x + b * y = g
+	BigInt xgcd(const BigInt &a, const BigInt &b, BigInt &x, BigInt &y);
+
+	//the inverse of a modulo m in [0, m); throws if they share a factor
+	BigInt modinv(const BigInt &a, const BigInt &m);
+
+
+	//x * x through the squaring kernels, which compute each cross product
+	//once; x * x and x *= x find them on their own
+	BigInt square(const BigInt &x);
+
+	//base^exponent by left-to-right squaring; a power of two in the base
+	//turns into a single shift
+	BigInt pow(const BigInt &base, uint64_t exponent);
+
+	//floor of the square root and the k-th root rounded toward zero, by
+	//Newton's iteration started from the root of the leading half of the
+	//bits, so both cost a few divisions. Negative n only for odd k.
+	BigInt isqrt(const BigInt &n);
+	BigInt iroot(const BigInt &n, uint64_t k);
 }
 
 
+//murmur3 over the limbs, seeded with the sign
+template <>
+struct std::hash<algo::bigint::BigInt> {
+	size_t operator()(const algo::bigint::BigInt &x) const;
+};
+
+
 #endif
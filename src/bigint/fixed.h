@@ -0,0 +1,315 @@
+#ifndef ALGO_BIGINT_FIXED_H
+#define ALGO_BIGINT_FIXED_H
+
+
+#include <cstdint>
+#include <cstddef>
+
+#include "bigint.h"
+
+
+namespace algo::bigint
+{
+	//unsigned integer of exactly Bits bits kept inline, with arithmetic
+	//modulo 2^Bits. The kernels follow algorithm_a, algorithm_s and
+	//algorithm_m over a trip count fixed at compile time, so they unroll
+	//to straight-line code and can run in constant expressions.
+	template <size_t Bits>
+	class FixedUInt {
+		static_assert(Bits > 0 && Bits % 32 == 0, "Bits must be a multiple of 32");
+
+	public:
+		static constexpr size_t LIMBS = Bits / 32;
+
+		constexpr FixedUInt()
+		: repr{}
+		{}
+
+		constexpr FixedUInt(uint64_t value)
+		: repr{}
+		{
+			repr[0] = (uint32_t)value;
+			if (LIMBS > 1) {
+				repr[1] = (uint32_t)(value >> 32);
+			}
+		}
+
+		//value modulo 2^Bits, so negative numbers wrap to two's complement
+		explicit FixedUInt(const BigInt &value)
+		: repr{}
+		{
+			const Limbs &limbs = value.limbs();
+			size_t n = limbs.size() < LIMBS ? limbs.size() : LIMBS;
+
+			for (size_t i = 0; i < n; i++) {
+				repr[i] = limbs[i];
+			}
+
+			if (value.is_negative()) {
+				*this = FixedUInt() - *this;
+			}
+		}
+
+		BigInt
+		to_bigint() const
+		{
+			return BigInt(Limbs(repr, repr + LIMBS), false);
+		}
+
+		constexpr uint32_t
+		limb(size_t i) const
+		{
+			return repr[i];
+		}
+
+		constexpr const uint32_t *
+		data() const
+		{
+			return repr;
+		}
+
+		//the sum, setting *carry to the bit shifted out of the top
+		constexpr FixedUInt
+		add(const FixedUInt &op, bool *carry = nullptr) const
+		{
+			FixedUInt w;
+			uint32_t sum_a = 0, sum_b = 0;
+			bool k = false, carry_a = false, carry_b = false;
+
+#pragma GCC unroll 64
+			for (size_t j = 0; j < LIMBS; j++) {
+				sum_a = repr[j] + op.repr[j];
+				carry_a = (sum_a < repr[j]);
+
+				sum_b = sum_a + k;
+				carry_b = (sum_b < sum_a);
+
+				w.repr[j] = sum_b;
+				k = carry_a || carry_b;
+			}
+
+			if (carry) {
+				*carry = k;
+			}
+
+			return w;
+		}
+
+		//the difference, setting *borrow when op is the larger
+		constexpr FixedUInt
+		sub(const FixedUInt &op, bool *borrow = nullptr) const
+		{
+			FixedUInt w;
+			uint32_t diff_a = 0, diff_b = 0;
+			bool k = false, borrow_a = false, borrow_b = false;
+
+#pragma GCC unroll 64
+			for (size_t j = 0; j < LIMBS; j++) {
+				diff_a = repr[j] - op.repr[j];
+				borrow_a = (diff_a > repr[j]);
+
+				diff_b = diff_a - k;
+				borrow_b = (diff_b > diff_a);
+
+				w.repr[j] = diff_b;
+				k = borrow_a || borrow_b;
+			}
+
+			if (borrow) {
+				*borrow = k;
+			}
+
+			return w;
+		}
+
+		constexpr FixedUInt
+		operator+(const FixedUInt &op) const
+		{
+			return add(op);
+		}
+
+		constexpr FixedUInt
+		operator-(const FixedUInt &op) const
+		{
+			return sub(op);
+		}
+
+		//algorithm_m with the partial products past the top limb skipped
+		constexpr FixedUInt
+		operator*(const FixedUInt &op) const
+		{
+			FixedUInt w;
+			uint64_t t = 0;
+			uint32_t k = 0;
+
+#pragma GCC unroll 64
+			for (size_t j = 0; j < LIMBS; j++) {
+				k = 0;
+
+#pragma GCC unroll 64
+				for (size_t i = 0; i + j < LIMBS; i++) {
+					t = (uint64_t)repr[i] * op.repr[j] + w.repr[i + j] + k;
+					w.repr[i + j] = (uint32_t)t;
+					k = (uint32_t)(t >> 32);
+				}
+			}
+
+			return w;
+		}
+
+		constexpr FixedUInt
+		operator<<(size_t shift) const
+		{
+			FixedUInt w;
+			size_t limbs = shift / 32, bits = shift % 32;
+
+			for (size_t i = LIMBS; i-- > limbs;) {
+				w.repr[i] = repr[i - limbs] << bits;
+				if (bits && i > limbs) {
+					w.repr[i] |= repr[i - limbs - 1] >> (32 - bits);
+				}
+			}
+
+			return w;
+		}
+
+		constexpr FixedUInt
+		operator>>(size_t shift) const
+		{
+			FixedUInt w;
+			size_t limbs = shift / 32, bits = shift % 32;
+
+			for (size_t i = 0; i + limbs < LIMBS; i++) {
+				w.repr[i] = repr[i + limbs] >> bits;
+				if (bits && i + limbs + 1 < LIMBS) {
+					w.repr[i] |= repr[i + limbs + 1] << (32 - bits);
+				}
+			}
+
+			return w;
+		}
+
+		constexpr FixedUInt &
+		operator+=(const FixedUInt &op)
+		{
+			return *this = *this + op;
+		}
+
+		constexpr FixedUInt &
+		operator-=(const FixedUInt &op)
+		{
+			return *this = *this - op;
+		}
+
+		constexpr FixedUInt &
+		operator*=(const FixedUInt &op)
+		{
+			return *this = *this * op;
+		}
+
+		constexpr FixedUInt &
+		operator<<=(size_t shift)
+		{
+			return *this = *this << shift;
+		}
+
+		constexpr FixedUInt &
+		operator>>=(size_t shift)
+		{
+			return *this = *this >> shift;
+		}
+
+		//-1, 0 or 1 like bigint_cmp
+		constexpr int
+		compare(const FixedUInt &op) const
+		{
+			for (size_t i = LIMBS; i-- > 0;) {
+				if (repr[i] != op.repr[i]) {
+					return repr[i] < op.repr[i] ? -1 : 1;
+				}
+			}
+
+			return 0;
+		}
+
+		constexpr bool
+		operator==(const FixedUInt &op) const
+		{
+			return compare(op) == 0;
+		}
+
+		constexpr bool
+		operator!=(const FixedUInt &op) const
+		{
+			return compare(op) != 0;
+		}
+
+		constexpr bool
+		operator<(const FixedUInt &op) const
+		{
+			return compare(op) < 0;
+		}
+
+		constexpr bool
+		operator<=(const FixedUInt &op) const
+		{
+			return compare(op) <= 0;
+		}
+
+		constexpr bool
+		operator>(const FixedUInt &op) const
+		{
+			return compare(op) > 0;
+		}
+
+		constexpr bool
+		operator>=(const FixedUInt &op) const
+		{
+			return compare(op) >= 0;
+		}
+
+	private:
+		template <size_t> friend class FixedUInt;
+
+		template <size_t B>
+		friend constexpr FixedUInt<2 * B> wide_multiply(const FixedUInt<B> &u, const FixedUInt<B> &v);
+
+		uint32_t repr[LIMBS];
+	};
+
+
+	//full 2 * Bits product, algorithm_m without truncation
+	template <size_t Bits>
+	constexpr FixedUInt<2 * Bits>
+	wide_multiply(const FixedUInt<Bits> &u, const FixedUInt<Bits> &v)
+	{
+		const size_t n = FixedUInt<Bits>::LIMBS;
+		FixedUInt<2 * Bits> w;
+		uint64_t t = 0;
+		uint32_t k = 0;
+
+#pragma GCC unroll 64
+		for (size_t j = 0; j < n; j++) {
+			k = 0;
+
+#pragma GCC unroll 64
+			for (size_t i = 0; i < n; i++) {
+				t = (uint64_t)u.repr[i] * v.repr[j] + w.repr[i + j] + k;
+				w.repr[i + j] = (uint32_t)t;
+				k = (uint32_t)(t >> 32);
+			}
+
+			w.repr[j + n] = k;
+		}
+
+		return w;
+	}
+
+
+	typedef FixedUInt<128> UInt128;
+	typedef FixedUInt<256> UInt256;
+	typedef FixedUInt<512> UInt512;
+}
+
+
+#endif
@@ -0,0 +1,343 @@
+#ifndef ALGO_BIGINT_LIMBS_H
+#define ALGO_BIGINT_LIMBS_H
+
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+#include "memory.h"
+
+
+namespace algo::bigint
+{
+	//limb array keeping up to INLINE_LIMBS limbs (256 bits) inside the
+	//object and moving to the heap only when it grows past that; the heap
+	//buffer comes from the thread's memory_resource() at the first spill
+	//unless a resource is bound at construction, and a move hands the
+	//buffer over together with the resource that owns it, leaving the
+	//source unbound
+	class Limbs {
+	public:
+		static const size_t INLINE_LIMBS = 8;
+
+		Limbs()
+		: ptr(local), len(0), cap(INLINE_LIMBS), resource(nullptr)
+		{}
+
+		explicit Limbs(std::pmr::memory_resource *resource)
+		: ptr(local), len(0), cap(INLINE_LIMBS), resource(resource)
+		{}
+
+		explicit Limbs(size_t n, uint32_t value = 0)
+		: ptr(local), len(0), cap(INLINE_LIMBS), resource(nullptr)
+		{
+			resize(n, value);
+		}
+
+		Limbs(const uint32_t *first, const uint32_t *last)
+		: ptr(local), len(0), cap(INLINE_LIMBS), resource(nullptr)
+		{
+			assign(first, last);
+		}
+
+		Limbs(const std::vector<uint32_t> &array)
+		: ptr(local), len(0), cap(INLINE_LIMBS), resource(nullptr)
+		{
+			assign(array.data(), array.data() + array.size());
+		}
+
+		Limbs(const Limbs &other)
+		: ptr(local), len(0), cap(INLINE_LIMBS), resource(nullptr)
+		{
+			assign(other.begin(), other.end());
+		}
+
+		Limbs(Limbs &&other) noexcept
+		: ptr(local), len(0), cap(INLINE_LIMBS), resource(nullptr)
+		{
+			steal(other);
+		}
+
+		~Limbs()
+		{
+			release();
+		}
+
+		Limbs &
+		operator=(const Limbs &other)
+		{
+			if (this != &other) {
+				assign(other.begin(), other.end());
+			}
+
+			return *this;
+		}
+
+		Limbs &
+		operator=(Limbs &&other)
+		{
+			//a buffer from another resource is copied into ours instead
+			if (this != &other) {
+				if (resource && other.on_heap() && other.resource != resource) {
+					assign(other.begin(), other.end());
+					other.clear();
+				} else {
+					release();
+					ptr = local;
+					len = 0;
+					cap = INLINE_LIMBS;
+					steal(other);
+				}
+			}
+
+			return *this;
+		}
+
+		size_t
+		size() const
+		{
+			return len;
+		}
+
+		size_t
+		capacity() const
+		{
+			return cap;
+		}
+
+		bool
+		empty() const
+		{
+			return len == 0;
+		}
+
+		uint32_t *
+		data()
+		{
+			return ptr;
+		}
+
+		const uint32_t *
+		data() const
+		{
+			return ptr;
+		}
+
+		uint32_t *
+		begin()
+		{
+			return ptr;
+		}
+
+		uint32_t *
+		end()
+		{
+			return ptr + len;
+		}
+
+		const uint32_t *
+		begin() const
+		{
+			return ptr;
+		}
+
+		const uint32_t *
+		end() const
+		{
+			return ptr + len;
+		}
+
+		uint32_t &
+		operator[](size_t i)
+		{
+			return ptr[i];
+		}
+
+		const uint32_t &
+		operator[](size_t i) const
+		{
+			return ptr[i];
+		}
+
+		uint32_t &
+		back()
+		{
+			return ptr[len - 1];
+		}
+
+		const uint32_t &
+		back() const
+		{
+			return ptr[len - 1];
+		}
+
+		void
+		reserve(size_t n)
+		{
+			uint32_t *p;
+
+			if (n <= cap) {
+				return;
+			}
+
+			if (n < cap * 2) {
+				n = cap * 2;
+			}
+
+			if (!resource) {
+				resource = memory_resource();
+			}
+
+			p = (uint32_t *)resource->allocate(n * sizeof(uint32_t), alignof(uint32_t));
+			std::memcpy(p, ptr, len * sizeof(uint32_t));
+			release();
+
+			ptr = p;
+			cap = n;
+		}
+
+		void
+		resize(size_t n, uint32_t value = 0)
+		{
+			reserve(n);
+
+			for (size_t i = len; i < n; i++) {
+				ptr[i] = value;
+			}
+			len = n;
+		}
+
+		void
+		clear()
+		{
+			len = 0;
+		}
+
+		void
+		push_back(uint32_t value)
+		{
+			reserve(len + 1);
+			ptr[len++] = value;
+		}
+
+		void
+		assign(size_t n, uint32_t value)
+		{
+			len = 0;
+			resize(n, value);
+		}
+
+		void
+		assign(const uint32_t *first, const uint32_t *last)
+		{
+			size_t n = last - first;
+
+			len = 0;
+			reserve(n);
+			std::memmove(ptr, first, n * sizeof(uint32_t));
+			len = n;
+		}
+
+		uint32_t *
+		insert(uint32_t *pos, const uint32_t *first, const uint32_t *last)
+		{
+			size_t at = pos - ptr;
+			size_t n = last - first;
+			Limbs source;
+
+			//a source inside this buffer would move under us, stage it
+			if (first >= ptr && first < ptr + cap) {
+				source.assign(first, last);
+				first = source.ptr;
+			}
+
+			reserve(len + n);
+			std::memmove(ptr + at + n, ptr + at, (len - at) * sizeof(uint32_t));
+			std::memcpy(ptr + at, first, n * sizeof(uint32_t));
+			len += n;
+
+			return ptr + at;
+		}
+
+		void
+		swap(Limbs &other)
+		{
+			Limbs t(std::move(other));
+
+			other = std::move(*this);
+			*this = std::move(t);
+		}
+
+		std::vector<uint32_t>
+		to_vector() const
+		{
+			return std::vector<uint32_t>(ptr, ptr + len);
+		}
+
+		std::pmr::memory_resource *
+		get_resource() const
+		{
+			return resource;
+		}
+
+		bool
+		operator==(const Limbs &other) const
+		{
+			return len == other.len
+				&& std::memcmp(ptr, other.ptr, len * sizeof(uint32_t)) == 0;
+		}
+
+		bool
+		operator!=(const Limbs &other) const
+		{
+			return !(*this == other);
+		}
+
+	private:
+		uint32_t *ptr;
+		size_t len, cap;
+		std::pmr::memory_resource *resource;
+		uint32_t local[INLINE_LIMBS];
+
+		bool
+		on_heap() const
+		{
+			return ptr != local;
+		}
+
+		void
+		release()
+		{
+			if (on_heap()) {
+				resource->deallocate(ptr, cap * sizeof(uint32_t), alignof(uint32_t));
+			}
+		}
+
+		//takes other's contents; this must be empty and inline. other is
+		//left unbound, so if it grows again it allocates from the thread's
+		//resource and not from one that may have been released since
+		void
+		steal(Limbs &other)
+		{
+			if (other.on_heap()) {
+				ptr = other.ptr;
+				cap = other.cap;
+				resource = other.resource;
+			} else {
+				std::memcpy(local, other.local, sizeof(local));
+			}
+			len = other.len;
+
+			other.ptr = other.local;
+			other.len = 0;
+			other.cap = INLINE_LIMBS;
+			other.resource = nullptr;
+		}
+	};
+}
+
+
+#endif
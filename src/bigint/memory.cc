@@ -0,0 +1,246 @@
+#include <cstdint>
+
+#include "memory.h"
+
+
+//chunk and block headers keep the memory after them fully aligned
+#define HEADER_SIZE alignof(std::max_align_t)
+#define POOL_BLOCK_SIZE (1 << 16)
+
+
+static thread_local std::pmr::memory_resource *current = nullptr;
+
+
+std::pmr::memory_resource *
+algo::bigint::memory_resource()
+{
+	return current ? current : std::pmr::new_delete_resource();
+}
+
+
+void
+algo::bigint::set_memory_resource(std::pmr::memory_resource *resource)
+{
+	current = resource;
+}
+
+
+static char *
+align_up(char *p, size_t alignment)
+{
+	uintptr_t x = (uintptr_t)p;
+
+	return p + ((alignment - x % alignment) % alignment);
+}
+
+
+algo::bigint::Arena::Arena(size_t chunk_size, std::pmr::memory_resource *upstream)
+: upstream(upstream), chunk_size(chunk_size), chunks(nullptr), cursor(nullptr), limit(nullptr)
+{}
+
+
+algo::bigint::Arena::~Arena()
+{
+	release();
+
+	if (chunks) {
+		upstream->deallocate(chunks, chunks->size, alignof(std::max_align_t));
+	}
+}
+
+
+void
+algo::bigint::Arena::release()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	Chunk *chunk;
+
+	if (!chunks) {
+		return;
+	}
+
+	while (chunks->next) {
+		chunk = chunks->next;
+		chunks->next = chunk->next;
+		upstream->deallocate(chunk, chunk->size, alignof(std::max_align_t));
+	}
+
+	cursor = (char *)chunks + HEADER_SIZE;
+	limit = (char *)chunks + chunks->size;
+}
+
+
+void *
+algo::bigint::Arena::do_allocate(size_t bytes, size_t alignment)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	char *p = cursor ? align_up(cursor, alignment) : nullptr;
+	Chunk *chunk;
+	size_t size;
+
+	if (!p || p + bytes > limit) {
+		size = HEADER_SIZE + bytes + alignment;
+		if (size < chunk_size) {
+			size = chunk_size;
+		}
+
+		chunk = (Chunk *)upstream->allocate(size, alignof(std::max_align_t));
+		chunk->size = size;
+
+		//the kept chunk is the head, so a bigger one replaces it there
+		if (chunks && chunk->size < chunks->size) {
+			chunk->next = chunks->next;
+			chunks->next = chunk;
+		} else {
+			chunk->next = chunks;
+			chunks = chunk;
+		}
+
+		p = align_up((char *)chunk + HEADER_SIZE, alignment);
+		limit = (char *)chunk + size;
+	}
+
+	cursor = p + bytes;
+
+	return p;
+}
+
+
+void
+algo::bigint::Arena::do_deallocate(void *p, size_t bytes, size_t alignment)
+{}
+
+
+bool
+algo::bigint::Arena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+	return this == &other;
+}
+
+
+algo::bigint::Arena &
+algo::bigint::thread_arena()
+{
+	static thread_local Arena arena;
+
+	return arena;
+}
+
+
+algo::bigint::Pool::Pool(std::pmr::memory_resource *upstream)
+: upstream(upstream), blocks(nullptr)
+{
+	for (int i = 0; i < CLASSES; i++) {
+		free_lists[i] = nullptr;
+	}
+}
+
+
+algo::bigint::Pool::~Pool()
+{
+	release();
+}
+
+
+void
+algo::bigint::Pool::release()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	Block *block;
+
+	while (blocks) {
+		block = blocks;
+		blocks = block->next;
+		upstream->deallocate(block, HEADER_SIZE + POOL_BLOCK_SIZE, alignof(std::max_align_t));
+	}
+
+	for (int i = 0; i < CLASSES; i++) {
+		free_lists[i] = nullptr;
+	}
+}
+
+
+//smallest class holding bytes, or CLASSES when the request is too large
+static int
+size_class(size_t bytes, size_t alignment, int min_class, int classes)
+{
+	int c = 0;
+
+	if (alignment > alignof(std::max_align_t)) {
+		return classes;
+	}
+
+	while (c < classes && ((size_t)1 << (c + min_class)) < bytes) {
+		c++;
+	}
+
+	return c;
+}
+
+
+void *
+algo::bigint::Pool::do_allocate(size_t bytes, size_t alignment)
+{
+	int c = size_class(bytes, alignment, MIN_CLASS, CLASSES);
+	size_t size = (size_t)1 << (c + MIN_CLASS);
+	Block *block;
+	char *p;
+	void *head;
+
+	if (c == CLASSES) {
+		return upstream->allocate(bytes, alignment);
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	if (!free_lists[c]) {
+		block = (Block *)upstream->allocate(HEADER_SIZE + POOL_BLOCK_SIZE, alignof(std::max_align_t));
+		block->next = blocks;
+		blocks = block;
+
+		//carve the whole block into the class's free list
+		p = (char *)block + HEADER_SIZE;
+		for (size_t i = 0; i + size <= POOL_BLOCK_SIZE; i += size) {
+			*(void **)(p + i) = free_lists[c];
+			free_lists[c] = p + i;
+		}
+	}
+
+	head = free_lists[c];
+	free_lists[c] = *(void **)head;
+
+	return head;
+}
+
+
+void
+algo::bigint::Pool::do_deallocate(void *p, size_t bytes, size_t alignment)
+{
+	int c = size_class(bytes, alignment, MIN_CLASS, CLASSES);
+
+	if (c == CLASSES) {
+		upstream->deallocate(p, bytes, alignment);
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	*(void **)p = free_lists[c];
+	free_lists[c] = p;
+}
+
+
+bool
+algo::bigint::Pool::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+	return this == &other;
+}
+
+
+algo::bigint::Pool &
+algo::bigint::thread_pool()
+{
+	static thread_local Pool pool;
+
+	return pool;
+}
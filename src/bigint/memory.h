@@ -0,0 +1,115 @@
+#ifndef ALGO_BIGINT_MEMORY_H
+#define ALGO_BIGINT_MEMORY_H
+
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+
+namespace algo::bigint
+{
+	//resource limb storage allocated on this thread draws from; nullptr
+	//restores the global new/delete resource
+	std::pmr::memory_resource *memory_resource();
+
+	void set_memory_resource(std::pmr::memory_resource *resource);
+
+
+	//installs a resource for the current thread until the end of the scope
+	class ResourceScope {
+	public:
+		explicit ResourceScope(std::pmr::memory_resource *resource)
+		: previous(memory_resource())
+		{
+			set_memory_resource(resource);
+		}
+
+		~ResourceScope()
+		{
+			set_memory_resource(previous);
+		}
+
+		ResourceScope(const ResourceScope &) = delete;
+		ResourceScope &operator=(const ResourceScope &) = delete;
+
+	private:
+		std::pmr::memory_resource *previous;
+	};
+
+
+	//bump allocator: deallocation is a no-op and everything is handed back
+	//at once by release(); values allocated from it must not outlive that.
+	//Allocation is synchronized, so values may grow on other threads.
+	class Arena : public std::pmr::memory_resource {
+	public:
+		explicit Arena(size_t chunk_size = 1 << 20,
+				std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+		~Arena();
+
+		Arena(const Arena &) = delete;
+		Arena &operator=(const Arena &) = delete;
+
+		//frees every chunk but the largest, which is kept for reuse
+		void release();
+
+	private:
+		struct Chunk {
+			Chunk *next;
+			size_t size;
+		};
+
+		std::pmr::memory_resource *upstream;
+		size_t chunk_size;
+		Chunk *chunks;
+		char *cursor, *limit;
+		std::mutex lock;
+
+		void *do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+	};
+
+	//arena owned by the calling thread
+	Arena &thread_arena();
+
+
+	//power of two size classes from 32 bytes to 64 KiB kept on free lists,
+	//larger requests go straight upstream. The free lists are guarded by a
+	//mutex, so values may be grown or freed on other threads, such as the
+	//workers of the parallel kernels.
+	class Pool : public std::pmr::memory_resource {
+	public:
+		explicit Pool(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+		~Pool();
+
+		Pool(const Pool &) = delete;
+		Pool &operator=(const Pool &) = delete;
+
+		//returns every block to upstream, invalidating all pooled memory
+		void release();
+
+	private:
+		static const int MIN_CLASS = 5;
+		static const int CLASSES = 12;
+
+		struct Block {
+			Block *next;
+		};
+
+		std::pmr::memory_resource *upstream;
+		void *free_lists[CLASSES];
+		Block *blocks;
+		std::mutex lock;
+
+		void *do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+	};
+
+	//pool owned by the calling thread
+	Pool &thread_pool();
+}
+
+
+#endif
@@ -0,0 +1,248 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "parallel.h"
+
+
+//tasks forked by one parallel_invoke call; the last one to finish wakes
+//the invoker if it is asleep
+struct join_state {
+	std::atomic<int> pending;
+	std::exception_ptr error;
+	std::mutex lock;
+	std::condition_variable done;
+};
+
+
+struct pool_task {
+	const std::function<void()> *fn;
+	join_state *join;
+};
+
+
+struct task_queue {
+	std::mutex lock;
+	std::deque<pool_task> tasks;
+};
+
+
+//each worker pushes and pops at the back of its own deque and steals from
+//the front of the others'; threads outside the pool share queue 0
+class WorkerPool {
+public:
+	WorkerPool(int threads);
+	~WorkerPool();
+
+	void invoke(const std::function<void()> *tasks, int count);
+
+private:
+	std::vector<std::unique_ptr<task_queue>> queues;
+	std::vector<std::thread> threads;
+	std::atomic<int> queued;
+	std::mutex sleep_lock;
+	std::condition_variable wake;
+	bool stopping;
+
+	void work(int index);
+	bool take(int index, pool_task &task);
+};
+
+
+static thread_local int queue_index = 0;
+
+//owns the workers, so they are joined at exit as well
+static std::unique_ptr<WorkerPool> pool;
+static std::atomic<int> thread_count(1);
+static std::atomic<int> threshold(PARALLEL_THRESHOLD);
+
+
+static void
+execute(const std::function<void()> &fn, join_state &join)
+{
+	std::exception_ptr error;
+
+	try {
+		fn();
+	} catch (...) {
+		error = std::current_exception();
+	}
+
+	//the invoker may return as soon as pending reaches zero, so join is
+	//not touched after the lock is released
+	std::lock_guard<std::mutex> guard(join.lock);
+
+	if (error && !join.error) {
+		join.error = error;
+	}
+	if (--join.pending == 0) {
+		join.done.notify_all();
+	}
+}
+
+
+WorkerPool::WorkerPool(int threads)
+: queued(0), stopping(false)
+{
+	for (int i = 0; i <= threads; i++) {
+		queues.emplace_back(new task_queue);
+	}
+
+	for (int i = 1; i <= threads; i++) {
+		this->threads.emplace_back(&WorkerPool::work, this, i);
+	}
+}
+
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(sleep_lock);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto &thread : threads) {
+		thread.join();
+	}
+}
+
+
+bool
+WorkerPool::take(int index, pool_task &task)
+{
+	int n = queues.size();
+
+	for (int i = 0; i < n; i++) {
+		task_queue &q = *queues[(index + i) % n];
+		std::lock_guard<std::mutex> guard(q.lock);
+
+		if (q.tasks.empty()) {
+			continue;
+		}
+
+		if (i == 0) {
+			task = q.tasks.back();
+			q.tasks.pop_back();
+		} else {
+			task = q.tasks.front();
+			q.tasks.pop_front();
+		}
+
+		queued--;
+		return true;
+	}
+
+	return false;
+}
+
+
+void
+WorkerPool::work(int index)
+{
+	pool_task task;
+
+	queue_index = index;
+
+	for (;;) {
+		if (take(index, task)) {
+			execute(*task.fn, *task.join);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> guard(sleep_lock);
+		wake.wait(guard, [this] { return stopping || queued > 0; });
+
+		if (stopping) {
+			return;
+		}
+	}
+}
+
+
+void
+WorkerPool::invoke(const std::function<void()> *tasks, int count)
+{
+	task_queue &own = *queues[queue_index];
+	join_state join;
+	pool_task task;
+
+	join.pending = count;
+
+	{
+		std::lock_guard<std::mutex> guard(own.lock);
+		for (int i = count - 1; i >= 1; i--) {
+			own.tasks.push_back({ &tasks[i], &join });
+		}
+	}
+	queued += count - 1;
+
+	//taking the lock orders the push before any worker's sleep check
+	{
+		std::lock_guard<std::mutex> guard(sleep_lock);
+	}
+	wake.notify_all();
+
+	execute(tasks[0], join);
+
+	//help with whatever is queued; once nothing is left our remaining
+	//tasks run elsewhere, so sleep until the last of them is done
+	while (join.pending > 0 && take(queue_index, task)) {
+		execute(*task.fn, *task.join);
+	}
+
+	std::unique_lock<std::mutex> guard(join.lock);
+
+	join.done.wait(guard, [&join] { return join.pending == 0; });
+
+	if (join.error) {
+		std::rethrow_exception(join.error);
+	}
+}
+
+
+void
+algo::bigint::set_parallelism(int threads, int threshold)
+{
+	pool.reset();
+
+	if (threads > 1) {
+		pool.reset(new WorkerPool(threads - 1));
+	}
+
+	thread_count = threads > 1 ? threads : 1;
+	::threshold = threshold;
+}
+
+
+int
+algo::bigint::parallel_threads()
+{
+	return thread_count;
+}
+
+
+bool
+algo::bigint::parallel_enabled(int n)
+{
+	return thread_count > 1 && n >= threshold;
+}
+
+
+void
+algo::bigint::parallel_invoke(const std::function<void()> *tasks, int count)
+{
+	if (!pool || count < 2) {
+		for (int i = 0; i < count; i++) {
+			tasks[i]();
+		}
+		return;
+	}
+
+	pool->invoke(tasks, count);
+}
@@ -0,0 +1,33 @@
+#ifndef ALGO_BIGINT_PARALLEL_H
+#define ALGO_BIGINT_PARALLEL_H
+
+
+#include <functional>
+
+
+#define PARALLEL_THRESHOLD 4096
+
+
+namespace algo::bigint
+{
+	//opt-in parallelism for huge operands. With more than one thread,
+	//products whose shorter operand has at least threshold limbs spread
+	//their sub-products, transforms and butterfly passes over a shared
+	//work-stealing pool, and division gains through the products it is
+	//built on. The calling thread counts as one of the threads. Change
+	//the setting only while no arithmetic is running.
+	void set_parallelism(int threads, int threshold = PARALLEL_THRESHOLD);
+
+	int parallel_threads();
+
+	//whether an operation over n limbs should fork
+	bool parallel_enabled(int n);
+
+	//runs the tasks to completion, the first on the calling thread, which
+	//keeps executing queued work while it waits for the rest; the first
+	//exception a task throws is rethrown here
+	void parallel_invoke(const std::function<void()> *tasks, int count);
+}
+
+
+#endif
@@ -0,0 +1,127 @@
+#include <stdexcept>
+
+#include "product.h"
+
+
+#define assert(x) if (!(x)) throw std::invalid_argument(#x)
+
+//ranges of at most this many terms are folded into machine words and
+//multiplied in with the scalar kernel
+#define PRODUCT_LEAF 16
+
+
+using algo::bigint::BigInt;
+
+
+//first * (first + step) * ... over count terms
+static BigInt
+range_product(uint64_t first, uint64_t count, uint64_t step)
+{
+	BigInt w = 1;
+	uint64_t acc = 1, x, t, i, h;
+
+	if (count > PRODUCT_LEAF) {
+		h = count / 2;
+		return range_product(first, h, step) * range_product(first + h * step, count - h, step);
+	}
+
+	for (i = 0; i < count; i++) {
+		x = first + i * step;
+		if (__builtin_mul_overflow(acc, x, &t)) {
+			w *= acc;
+			acc = x;
+		} else {
+			acc = t;
+		}
+	}
+	w *= acc;
+
+	return w;
+}
+
+
+void
+algo::bigint::split_range_check(uint64_t a, uint64_t b)
+{
+	assert(b > a && "Empty range!");
+}
+
+
+BigInt
+algo::bigint::product(const BigInt *factors, int count)
+{
+	size_t total = 0, half;
+	int i, h;
+
+	assert(count >= 0 && "Negative count!");
+
+	if (count == 0) {
+		return 1;
+	}
+	if (count == 1) {
+		return factors[0];
+	}
+
+	for (i = 0; i < count; i++) {
+		total += factors[i].bit_length();
+	}
+
+	//the left side takes factors while it holds at most half the bits,
+	//keeping at least one on each side
+	half = factors[0].bit_length();
+	for (h = 1; h < count - 1 && 2 * (half + factors[h].bit_length()) <= total; h++) {
+		half += factors[h].bit_length();
+	}
+
+	return product(factors, h) * product(factors + h, count - h);
+}
+
+
+//n! = 2^(n - popcount(n)) * odd(n) * odd(n / 2) * odd(n / 4) ..., where
+//odd(x) is the product of the odd numbers up to x, since the even factors
+//of n! are 2^(n / 2) * (n / 2)!. Each odd(n >> i) extends odd(n >> (i + 1))
+//by the odd numbers in between, taken as one balanced range product.
+BigInt
+algo::bigint::factorial(uint64_t n)
+{
+	BigInt w = 1, odd = 1;
+	uint64_t lo, hi, first;
+	int i;
+
+	if (n < 2) {
+		return w;
+	}
+
+	for (i = 63 - __builtin_clzll(n); i >= 0; i--) {
+		hi = n >> i;
+		lo = n >> (i + 1);
+		first = (lo + 1) | 1;
+
+		if (first <= hi) {
+			odd *= range_product(first, (hi - first) / 2 + 1, 2);
+		}
+		w *= odd;
+	}
+
+	return w << (n - __builtin_popcountll(n));
+}
+
+
+//the k factors above n - k over k!, with k the smaller side
+BigInt
+algo::bigint::binomial(uint64_t n, uint64_t k)
+{
+	if (k > n) {
+		return BigInt();
+	}
+
+	if (k > n - k) {
+		k = n - k;
+	}
+
+	if (k == 0) {
+		return 1;
+	}
+
+	return range_product(n - k + 1, k, 1) / factorial(k);
+}
@@ -0,0 +1,75 @@
+#ifndef ALGO_BIGINT_PRODUCT_H
+#define ALGO_BIGINT_PRODUCT_H
+
+
+#include <cstdint>
+
+#include "bigint.h"
+
+
+namespace algo::bigint
+{
+	//product of count factors through a balanced tree: each level splits
+	//where the bit lengths on either side are about equal, so the large
+	//products meet operands of similar size and reach Toom-3 and the NTT
+	//instead of growing one limb at a time. 1 for count == 0.
+	BigInt product(const BigInt *factors, int count);
+
+	//n! as the odd part, built from products of odd numbers over ranges
+	//that halve with each level, shifted left by the n - popcount(n)
+	//factors of two
+	BigInt factorial(uint64_t n);
+
+	//n! / (k! (n - k)!), 0 for k > n
+	BigInt binomial(uint64_t n, uint64_t k);
+
+
+	//P, Q and T of the terms [a, b) of a hypergeometric series
+	//
+	//	S = sum over k of coeff(k) * p(a) ... p(k) / (q(a) ... q(k))
+	//
+	//with P = p(a) ... p(b - 1), Q = q(a) ... q(b - 1) and S(a, b) = T / Q
+	struct SplitTerms {
+		BigInt p, q, t;
+	};
+
+
+	//throws std::invalid_argument unless b > a: the precondition of
+	//binary_split, kept out of line with the other asserts of product.cc
+	void split_range_check(uint64_t a, uint64_t b);
+
+
+	//binary splitting: halves of the range are combined as P = P1 P2,
+	//Q = Q1 Q2 and T = T1 Q2 + P1 T2, so every level multiplies numbers of
+	//about the same size. p, q and coeff map a uint64_t index to a BigInt
+	//or a native integer; b must be above a.
+	template <typename PFn, typename QFn, typename CoeffFn>
+	SplitTerms
+	binary_split(uint64_t a, uint64_t b, const PFn &p, const QFn &q, const CoeffFn &coeff)
+	{
+		SplitTerms left, right;
+		uint64_t m;
+
+		split_range_check(a, b);
+
+		if (b - a == 1) {
+			left.p = BigInt(p(a));
+			left.q = BigInt(q(a));
+			left.t = left.p * BigInt(coeff(a));
+			return left;
+		}
+
+		m = a + (b - a) / 2;
+		left = binary_split(a, m, p, q, coeff);
+		right = binary_split(m, b, p, q, coeff);
+
+		left.t = std::move(left.t) * right.q + left.p * right.t;
+		left.p = std::move(left.p) * right.p;
+		left.q = std::move(left.q) * right.q;
+
+		return left;
+	}
+}
+
+
+#endif
@@ -1,7 +1,87 @@
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include <unistd.h>
 #include "../src/hash/hash.h"
 #include "../src/search/a_star.h"
 #include "../src/bigint/bigint.h"
+#include "../src/bigint/fixed.h"
+#include "../src/bigint/parallel.h"
+#include "../src/bigint/batch.h"
+#include "../src/bigint/product.h"
+
+
+static int failures = 0;
+
+
+//reports a failed check and counts it for the exit status
+static void
+check(bool ok, int line, const char *what)
+{
+	if (!ok) {
+		std::cout << "FAIL line " << line << ": " << what << std::endl;
+		failures++;
+	}
+}
+
+#define CHECK(x) check((x), __LINE__, #x)
+
+
+static uint64_t seed = 88172645463325252ULL;
+
+//n xorshift limbs with the top one nonzero
+static algo::bigint::BigInt
+random_bigint(int n, bool negative = false)
+{
+	std::vector<uint32_t> limbs(n);
+
+	for (int i = 0; i < n; i++) {
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		limbs[i] = (uint32_t)(seed >> 32);
+	}
+	limbs[n - 1] |= 1;
+
+	return algo::bigint::BigInt(limbs, negative);
+}
+
+
+//u * v as the sum of u times piece-limb slices of v, so the products run
+//on the tier that piece limbs select and not on the one u * v would take
+static algo::bigint::BigInt
+split_product(const algo::bigint::BigInt &u, const algo::bigint::BigInt &v, int piece)
+{
+	const algo::bigint::Limbs &limbs = v.limbs();
+	algo::bigint::BigInt w;
+	int n = limbs.size(), len;
+
+	for (int i = 0; i < n; i += piece) {
+		len = n - i < piece ? n - i : piece;
+		w += (u * algo::bigint::BigInt(algo::bigint::BigIntView(limbs.data() + i, len))) << (32 * (size_t)i);
+	}
+
+	return v.is_negative() ? algo::bigint::BigInt() - w : w;
+}
+
+
+//10^d through the scalar kernel alone
+static algo::bigint::BigInt
+power_of_ten(int d)
+{
+	algo::bigint::BigInt w = 1;
+
+	for (; d >= 9; d -= 9) {
+		w *= 1000000000;
+	}
+	for (; d > 0; d--) {
+		w *= 10;
+	}
+
+	return w;
+}
 
 
 int
@@ -138,15 +218,915 @@ main(int argc, char **argv)
 	if (int1 == int2) std::cout << "Equal" << std::endl;
 	else std::cout << "Not equal" << std::endl;
 
+	CHECK(int1 + int2 < int1 && int1 < int1 - int2 && !(int1 < int2) && int1 <= int2 && int1 >= int2);
+
 	std::cout << (int1 + int2).to_string() << std::endl;
 
 	std::cout << (int1 - int2).to_string() << std::endl;
 
 	std::cout << (int1 * int2).to_string() << std::endl;
 
+	CHECK((int1 * int2).bit_length() == 74);
+
+	//normalized form: no high zero limbs, zero never negative and the
+	//cached bit length right on both sides of every power of two
+	auto padded = algo::bigint::BigInt(std::vector<uint32_t>{ 5, 0, 0 }, true);
+	auto zeros = algo::bigint::BigInt(std::vector<uint32_t>{ 0, 0 }, true);
+	auto cancelled = int1 - int1;
+
+	CHECK(padded.limbs().size() == 1 && padded == -5 && padded.bit_length() == 3);
+	CHECK(zeros.is_empty() && !zeros.is_negative() && zeros.bit_length() == 0 && zeros == 0);
+	CHECK(cancelled.is_empty() && !cancelled.is_negative() && !algo::bigint::BigInt("-0").is_negative());
+	CHECK((int1 * 0).is_empty() && !(int1 * 0).is_negative() && !(int1 % 1).is_negative());
+
+	for (size_t k = 0; k < 300; k++) {
+		auto power = algo::bigint::BigInt(1) << k;
+
+		CHECK(power.bit_length() == k + 1 && (power - 1).bit_length() == k);
+		CHECK((power * -3).bit_length() == k + 2 && (power - 1).limbs().size() == (k + 31) / 32);
+	}
+
+	CHECK((int1 * int2).to_hex() == "21e19e0c9bab2400000");
+
+	//byte and hex conversions both ways and in both byte orders, and the
+	//view operators over borrowed limbs, high zeros included, against the
+	//BigInt ones
+	uint8_t be[] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+	auto from_be = algo::bigint::BigInt::from_bytes(be, 9);
+	auto from_le = algo::bigint::BigInt::from_bytes(be, 9, false, true);
+	uint8_t padded_bytes[12];
+
+	CHECK(from_be == algo::bigint::BigInt::from_hex("0x0102030405060708"));
+	CHECK(from_le == algo::bigint::BigInt::from_hex("-0X080706050403020100") && from_le.to_hex() == "-80706050403020100");
+	CHECK(from_be.to_bytes() == std::vector<uint8_t>(be + 1, be + 9) && from_le.to_bytes(false) == std::vector<uint8_t>(be, be + 9));
+	CHECK(algo::bigint::BigInt::from_hex("aBcDeF") == 0xabcdef && algo::bigint::BigInt().to_bytes().empty());
+
+	from_be.to_bytes(padded_bytes, 12);
+	CHECK(padded_bytes[0] == 0 && padded_bytes[3] == 0 && padded_bytes[4] == 1 && padded_bytes[11] == 8);
+
+	for (int n : { 1, 7, 8, 9, 60, 170, 250 }) {
+		auto a = random_bigint(n, true);
+		auto b = random_bigint(n / 2 + 1);
+		auto big_endian = a.to_bytes(), little_endian = a.to_bytes(false);
+		auto raw = a.limbs().to_vector();
+
+		raw.push_back(0);
+		raw.push_back(0);
+
+		auto view = algo::bigint::BigIntView(raw.data(), raw.size(), true);
+
+		CHECK(algo::bigint::BigInt::from_bytes(big_endian.data(), big_endian.size(), true, true) == a);
+		CHECK(algo::bigint::BigInt::from_bytes(little_endian.data(), little_endian.size(), false, true) == a);
+		CHECK(algo::bigint::BigInt::from_hex(a.to_hex().c_str()) == a);
+		CHECK(view.size() == n && algo::bigint::BigInt(view) == a);
+		CHECK(view + b == a + b && view - b == a - b && view * b == a * b);
+		CHECK(view / b == a / b && view % b == a % b);
+		CHECK(algo::bigint::compare(view, b) == a.compare(b) && algo::bigint::compare(view, a) == 0);
+	}
+
+	CHECK(((int1 << 40) >> 3 ^ ~int2) == algo::bigint::BigInt("-13743895347100000000001"));
+
+	//ordering agrees with the sign of the difference across signs and
+	//lengths, and equal values hash alike however they were built
+	algo::bigint::BigInt ordered[] = {
+		random_bigint(5, true), random_bigint(2, true), -1, 0, 1,
+		random_bigint(1), random_bigint(2), random_bigint(2), random_bigint(5), random_bigint(9),
+	};
+	std::hash<algo::bigint::BigInt> hasher;
+	std::unordered_set<algo::bigint::BigInt> seen;
+
+	for (auto &a : ordered) {
+		for (auto &b : ordered) {
+			auto difference = a - b;
+			int sign = difference.is_negative() ? -1 : difference.is_empty() ? 0 : 1;
+
+			CHECK(a.compare(b) == sign && (a < b) == (sign < 0) && (a <= b) == (sign <= 0));
+			CHECK((a > b) == (sign > 0) && (a >= b) == (sign >= 0) && (a == b) == (sign == 0) && (a != b) == (sign != 0));
+		}
+
+		seen.insert(a);
+		CHECK(hasher(a) == hasher(algo::bigint::BigInt(a.to_string().c_str())) && hasher(a) == hasher(a * 3 / 3));
+	}
+
+	CHECK(seen.size() == 10 && seen.count(algo::bigint::BigInt(ordered[7].to_string().c_str())) == 1 && seen.count(2) == 0);
+	CHECK(hasher(int1) != hasher(int1 * -1) && hasher(0) == hasher(int1 - int1));
+
+	//bitwise operators and shifts on lengths around the eight-limb vector
+	//width, for both signs, bit by bit and against arithmetic
+	int bitwise_sizes[] = { 1, 7, 8, 9, 15, 16, 17, 33, 100 };
+
+	for (int n : bitwise_sizes) {
+		auto a = random_bigint(n, n & 1);
+		auto b = random_bigint(n + 3 - n % 5, n % 3 == 0);
+		auto both = a & b, either = a | b, other = a ^ b, flipped = ~a;
+
+		for (size_t i = 0; i < 32 * (size_t)n + 140; i += 7) {
+			CHECK(both.test_bit(i) == (a.test_bit(i) && b.test_bit(i)));
+			CHECK(either.test_bit(i) == (a.test_bit(i) || b.test_bit(i)));
+			CHECK(other.test_bit(i) == (a.test_bit(i) != b.test_bit(i)));
+			CHECK(flipped.test_bit(i) == !a.test_bit(i));
+		}
+		CHECK(both + either == a + b && other == either - both && flipped + a == -1);
+
+		for (size_t k : { 1, 5, 31, 32, 33, 100, 257 }) {
+			auto power = algo::bigint::BigInt(1) << k;
+			auto floor = a >> k;
+
+			CHECK((a << k) == a * power && (a << k) >> k == a);
+			CHECK(floor * power <= a && a < (floor + 1) * power);
+		}
+	}
+
 	std::cout << (int1 / int2).to_string() << std::endl;
 
 	std::cout << (int1 % int2).to_string() << std::endl;
 
-	return 0;
+	//decimal conversion on both sides of the divide and conquer switch,
+	//540 digits in and 60 limbs out, with zero blocks inside the number
+	//and random values checked by their lowest and highest nine digits
+	int digit_counts[] = { 1, 9, 10, 539, 540, 541, 1153, 5000 };
+
+	for (int d : digit_counts) {
+		auto ten = power_of_ten(d);
+		auto edges = "1" + std::string(d - 1, '0') + "1";
+		auto nines = std::string(d, '9');
+
+		CHECK(algo::bigint::BigInt(edges) == ten + 1 && (ten + 1).to_string() == edges);
+		CHECK(algo::bigint::BigInt(nines) == ten - 1 && (ten - 1).to_string() == nines);
+		CHECK(algo::bigint::BigInt(("-000" + nines).c_str()) == 1 - ten);
+		CHECK((1 - ten).to_string() == "-" + nines);
+	}
+
+	int decimal_sizes[] = { 2, 59, 60, 61, 150, 1000 };
+
+	for (int n : decimal_sizes) {
+		auto x = random_bigint(n);
+		auto text = x.to_string();
+		int d = text.size();
+
+		CHECK(algo::bigint::BigInt(text) == x);
+		CHECK(algo::bigint::BigInt(text.substr(d - 9).c_str()) == x % 1000000000);
+		CHECK(algo::bigint::BigInt(text.substr(0, 9).c_str()) == x / power_of_ten(d - 9));
+	}
+
+	//the word-pair loops with odd tails, single limbs and carries that run
+	//through every pair: all-ones operands of 2^(32k) - 1
+	int word_sizes[] = { 1, 2, 3, 4, 5, 7, 9, 16, 33 };
+
+	for (int j : word_sizes) {
+		auto ones_j = algo::bigint::BigInt(std::vector<uint32_t>(j, 0xffffffff), false);
+		auto power_j = algo::bigint::BigInt(1) << (32 * j);
+
+		CHECK(ones_j + 1 == power_j);
+		CHECK(1 + ones_j == power_j);
+		CHECK(ones_j + ones_j == power_j * 2 - 2);
+		CHECK(power_j - 1 == ones_j);
+		CHECK(power_j - ones_j == 1);
+		CHECK(1 - power_j + ones_j == 0);
+
+		for (int k : word_sizes) {
+			auto ones_k = algo::bigint::BigInt(std::vector<uint32_t>(k, 0xffffffff), false);
+			auto power_k = algo::bigint::BigInt(1) << (32 * k);
+			auto u = random_bigint(j);
+			auto v = random_bigint(k);
+
+			CHECK(ones_j * ones_k == (power_j << (32 * k)) - power_j - power_k + 1);
+			CHECK(u * v % 4294967291U == u % 4294967291U * (v % 4294967291U) % 4294967291U);
+		}
+	}
+
+	//both sides of the Karatsuba and Toom-3 thresholds, balanced and not,
+	//against products of 32-limb slices, which stay on the schoolbook kernel
+	int tier_sizes[] = { 47, 48, 49, 239, 240, 241 };
+
+	for (int n : tier_sizes) {
+		auto a = random_bigint(n);
+		auto b = random_bigint(n, true);
+		auto c = random_bigint(n + n / 3);
+		auto d = random_bigint(2 * n + 3);
+
+		CHECK(a * b == split_product(a, b, 32));
+		CHECK(c * b == split_product(c, b, 32));
+		CHECK(b * d == split_product(d, b, 32));
+	}
+
+	//the NTT on dense limbs against products of 750-limb slices, which
+	//split into Toom-3 products
+	int ntt_sizes[] = { 1499, 1500, 1501 };
+
+	for (int n : ntt_sizes) {
+		auto a = random_bigint(n);
+		auto b = random_bigint(n, true);
+		auto c = random_bigint(2 * n - 100);
+
+		CHECK(a * b == split_product(a, b, 750));
+		CHECK(c * b == split_product(c, b, 750));
+		CHECK(a * a == split_product(a, a, 750));
+	}
+
+	//compound and rvalue forms against the binary ones, and each operator
+	//with itself on both sides, small to Toom-3 sized
+	int operator_sizes[] = { 1, 3, 9, 60, 300 };
+
+	for (int n : operator_sizes) {
+		auto a = random_bigint(n, true);
+		auto b = random_bigint(n / 2 + 1);
+		auto a_copy = a;
+		auto x = a;
+
+		CHECK((x += b) == a + b && (x -= b) == a);
+		CHECK((x *= b) == a * b && (x /= b) == a);
+		CHECK((x %= b) == a % b);
+		CHECK(algo::bigint::BigInt(a) + b == a + b && algo::bigint::BigInt(a) - b == a - b);
+		CHECK(algo::bigint::BigInt(a) * b == a * b && algo::bigint::BigInt(a) / b == a / b);
+		CHECK(algo::bigint::BigInt(a) % b == a % b);
+
+		x = a;
+		CHECK((x *= x) == a * a_copy);
+		x = a;
+		CHECK((x += x) == a * 2 && (x -= x) == 0);
+		x = a;
+		CHECK((x /= x) == 1);
+		x = a;
+		CHECK((x %= x) == 0);
+		x = a;
+		CHECK(std::move(x) * x == a * a_copy);
+	}
+
+	//values growing and shrinking across the inline limit, and copies and
+	//moves of inline and heap values: a move hands the heap buffer over
+	//and leaves a usable empty number behind
+	auto inline_top = algo::bigint::BigInt(std::vector<uint32_t>(8, 0xffffffff), false);
+	auto spilled = inline_top + 1;
+	auto inline_size = algo::bigint::Limbs::INLINE_LIMBS;
+
+	CHECK(inline_top.limbs().size() == 8 && inline_top.limbs().capacity() == inline_size);
+	CHECK(spilled.limbs().size() == 9 && spilled == algo::bigint::BigInt(1) << 256);
+	CHECK(spilled - 1 == inline_top && (spilled - 1).limbs().size() == 8);
+
+	int storage_sizes[] = { 1, 7, 8, 9, 40 };
+
+	for (int n : storage_sizes) {
+		auto a = random_bigint(n, true);
+		auto copy = a;
+		auto moved = algo::bigint::BigInt(a);
+		const uint32_t *buffer = moved.limbs().data();
+		auto target = std::move(moved);
+		algo::bigint::BigInt assigned = 5;
+
+		CHECK(copy == a && copy.limbs().data() != a.limbs().data());
+		CHECK(target == a && (n <= 8 || target.limbs().data() == buffer));
+		CHECK(moved.is_empty() && moved + a == a);
+
+		moved = a * 3;
+		assigned = std::move(target);
+		CHECK(moved == a * 3 && assigned == a);
+		std::swap(assigned, spilled);
+		CHECK(spilled == a && assigned == algo::bigint::BigInt(1) << 256);
+		std::swap(assigned, spilled);
+	}
+
+	//division on both sides of the Burnikel-Ziegler thresholds, with
+	//79/80/81-limb divisors and a deeper recursion, the dividend 39/40/41
+	//limbs longer or far longer; all-ones quotients reach the B^h - 1
+	//estimate of div_3n_2n
+	int divisor_sizes[] = { 79, 80, 81, 330 };
+	int excess_sizes[] = { 39, 40, 41, 400 };
+
+	for (int s : divisor_sizes) {
+		for (int t : excess_sizes) {
+			auto d = random_bigint(s);
+			auto n = random_bigint(s + t);
+			auto q = n / d, r = n % d;
+			auto ones = algo::bigint::BigInt(std::vector<uint32_t>(t, 0xffffffff), false);
+			auto top = d * ones + d - 1;
+			auto neg = algo::bigint::BigInt() - n;
+
+			CHECK(q * d + r == n && r >= 0 && r < d);
+			CHECK(top / d == ones && top % d == d - 1);
+			CHECK(neg / d * d + neg % d == neg && neg % d <= 0 && neg % d + d > 0);
+		}
+	}
+
+	//scratch frames nested through Toom-3 inside Burnikel-Ziegler
+	//division, and products whose temporaries spill into further
+	//workspace chunks followed by smaller ones reusing them; the largest
+	//are checked modulo two primes
+	int frame_sizes[] = { 1400, 30000, 300, 30000, 1400 };
+
+	for (int n : frame_sizes) {
+		auto a = random_bigint(n);
+		auto b = random_bigint(n - n / 4, true);
+		auto x = a;
+
+		x *= b;
+		if (n < 2000) {
+			CHECK(x == split_product(a, b, 700));
+		}
+		CHECK(x % 4294967291U == a % 4294967291U * (b % 4294967291U) % 4294967291U);
+		CHECK(x % 4294967279U == a % 4294967279U * (b % 4294967279U) % 4294967279U);
+	}
+
+	auto frame_divisor = random_bigint(1100);
+	auto frame_dividend = random_bigint(3500);
+	auto frame_quotient = frame_dividend / frame_divisor;
+	auto frame_remainder = frame_dividend % frame_divisor;
+
+	CHECK(frame_quotient * frame_divisor + frame_remainder == frame_dividend);
+	CHECK(frame_remainder >= 0 && frame_remainder < frame_divisor);
+
+	auto modulus = algo::bigint::BigInt("1000000007");
+	auto reducer = algo::bigint::Reducer(modulus);
+
+	CHECK(reducer.reduce(int1 * int2) == 490000);
+
+	//Barrett reduction below, at and past the 2k-limb input it handles
+	//itself, for one- to multi-limb moduli, against operator%
+	int modulus_sizes[] = { 1, 2, 3, 33, 100 };
+
+	for (int k : modulus_sizes) {
+		auto m = random_bigint(k);
+		auto barrett = algo::bigint::Reducer(m);
+		algo::bigint::BigInt values[] = {
+			random_bigint(1), m - 1, m, m + 1, m * 12345,
+			random_bigint(2 * k - 1), random_bigint(2 * k), random_bigint(2 * k, true),
+			random_bigint(2 * k + 1), m * m - 1, random_bigint(3 * k + 5),
+		};
+		algo::bigint::BigInt base = random_bigint(k + 1, true), power = 1;
+
+		for (auto &x : values) {
+			CHECK(barrett.reduce(x) == x % m);
+		}
+
+		barrett.reduce(values, 11);
+		CHECK(values[4] == 0 && values[3] == 1 % m && values[7] < 0);
+
+		for (int e = 0; e <= 40; e++) {
+			CHECK(barrett.modpow(base, e) == (power % m + m) % m);
+			power *= base;
+		}
+	}
+
+	CHECK(algo::bigint::modpow(int1, int2 * int2, modulus) == 291872145);
+
+	//Montgomery powers for odd moduli: small exponents against repeated
+	//multiplication, exponents on both sides of each window size against
+	//the Barrett ladder, and products of powers from multi_modpow
+	auto mersenne = (algo::bigint::BigInt(1) << 127) - 1;
+
+	CHECK(algo::bigint::modpow(random_bigint(3, true), mersenne - 1, mersenne) == 1);
+
+	for (int k : modulus_sizes) {
+		auto m = random_bigint(k) | 1;
+		auto montgomery = algo::bigint::Montgomery(m);
+		auto barrett = algo::bigint::Reducer(m);
+		algo::bigint::BigInt base = random_bigint(k + 1, true), power = 1;
+		algo::bigint::BigInt bases[3], exponents[3];
+		int exponent_bits[] = { 24, 25, 80, 81, 240, 241, 672, 673, 2000 };
+
+		for (int e = 0; e <= 40; e++) {
+			CHECK(montgomery.modpow(base, e) == (power % m + m) % m);
+			power *= base;
+		}
+
+		for (int b : exponent_bits) {
+			auto one = algo::bigint::BigInt(1);
+			auto e = (random_bigint((b + 31) / 32) & ((one << b) - 1)) | one << (b - 1);
+
+			CHECK(montgomery.modpow(base, e) == barrett.modpow(base, e));
+		}
+
+		for (int i = 0; i < 3; i++) {
+			bases[i] = random_bigint(k, i == 1);
+			exponents[i] = random_bigint(i + 1);
+		}
+		CHECK(montgomery.multi_modpow(bases, exponents, 3) ==
+			montgomery.modpow(bases[0], exponents[0]) * montgomery.modpow(bases[1], exponents[1])
+			% m * montgomery.modpow(bases[2], exponents[2]) % m);
+	}
+
+	//values and the decimal power cache built inside an arena scope stay
+	//valid after the arena is released and reused
+	auto wide = random_bigint(3000);
+	std::string wide_text;
+
+	{
+		algo::bigint::ResourceScope scope(&algo::bigint::thread_arena());
+
+		CHECK((int1 * int1 * int1 * int1).to_string() == "1" + std::string(44, '0'));
+		wide_text = (wide * wide).to_string();
+	}
+	algo::bigint::thread_arena().release();
+	{
+		algo::bigint::ResourceScope scope(&algo::bigint::thread_arena());
+
+		CHECK(algo::bigint::BigInt(std::string(60000, '7').c_str()) % 1000 == 777);
+	}
+	algo::bigint::thread_arena().release();
+	CHECK((wide * wide).to_string() == wide_text);
+	CHECK(algo::bigint::BigInt(wide_text) == wide * wide);
+
+	//one pool serving threads that allocate and free from it at once,
+	//with the results freed on this thread
+	{
+		algo::bigint::Pool shared;
+		algo::bigint::BigInt results[4];
+		std::vector<std::thread> threads;
+
+		for (int t = 0; t < 4; t++) {
+			threads.emplace_back([&shared, &results, t] {
+				algo::bigint::ResourceScope scope(&shared);
+				algo::bigint::BigInt x = t + 2;
+
+				for (int i = 0; i < 12; i++) {
+					x = x * x + i;
+				}
+				results[t] = std::move(x);
+			});
+		}
+		for (auto &thread : threads) {
+			thread.join();
+		}
+
+		for (int t = 0; t < 4; t++) {
+			algo::bigint::BigInt x = t + 2;
+
+			for (int i = 0; i < 12; i++) {
+				x = x * x + i;
+			}
+			CHECK(results[t] == x && results[t].limbs().get_resource() == &shared);
+		}
+	}
+
+	//a moved-from Limbs lets go of the resource along with the buffer
+	{
+		algo::bigint::Arena arena;
+		algo::bigint::Limbs bound(&arena);
+
+		bound.resize(20, 7);
+
+		algo::bigint::Limbs owner(std::move(bound));
+
+		CHECK(owner.get_resource() == &arena && owner.size() == 20 && owner[19] == 7);
+		CHECK(bound.get_resource() == nullptr && bound.empty());
+		bound.resize(20, 1);
+		CHECK(bound.get_resource() == algo::bigint::memory_resource() && owner[0] == 7);
+	}
+
+	auto fixed = algo::bigint::UInt128(int1 * int2);
+
+	CHECK((fixed * fixed).to_bigint() == algo::bigint::BigInt("100000000000000000000000000000000000000000000") % (algo::bigint::BigInt(1) << 128));
+
+	//FixedUInt against BigInt arithmetic modulo 2^Bits, with the carry
+	//and borrow flags, the full product and constant expressions
+	static_assert((algo::bigint::UInt256(3) << 254 >> 254) == algo::bigint::UInt256(3), "constexpr shifts");
+	static_assert(algo::bigint::UInt128(0) - algo::bigint::UInt128(1) > algo::bigint::UInt128(1) << 127, "constexpr wrap");
+	static_assert((algo::bigint::UInt128(1) << 64) * (algo::bigint::UInt128(1) << 64) == algo::bigint::UInt128(0), "constexpr product");
+
+	auto mask256 = (algo::bigint::BigInt(1) << 256) - 1;
+
+	for (int i = 0; i < 50; i++) {
+		auto a = random_bigint(1 + i % 8), b = random_bigint(1 + i * 3 % 8, i & 1);
+		auto fa = algo::bigint::UInt256(a), fb = algo::bigint::UInt256(b);
+		auto ua = fa.to_bigint(), ub = fb.to_bigint();
+		bool carry, borrow;
+
+		CHECK(ua == (a & mask256) && ub == (b & mask256));
+		CHECK((fa + fb).to_bigint() == ((ua + ub) & mask256));
+		CHECK(fa.add(fb, &carry) == fa + fb && carry == (ua + ub > mask256));
+		CHECK((fa - fb).to_bigint() == ((ua - ub) & mask256));
+		CHECK(fa.sub(fb, &borrow) == fa - fb && borrow == (ua < ub));
+		CHECK((fa * fb).to_bigint() == ((ua * ub) & mask256));
+		CHECK(algo::bigint::wide_multiply(fa, fb).to_bigint() == ua * ub);
+		CHECK((fa << (i * 5)).to_bigint() == ((ua << (i * 5)) & mask256) && (fa >> (i * 5)).to_bigint() == ua >> (i * 5));
+		CHECK((fa < fb) == (ua < ub) && (fa == fb) == (ua == ub) && fa.compare(fb) == ua.compare(ub));
+	}
+
+	//parallel products and divisions of dense operands against the same
+	//operations run serially, with a shared pool installed meanwhile
+	int parallel_sizes[] = { 200, 1000, 3000 };
+	algo::bigint::BigInt parallel_u[3], parallel_v[3], serial_products[3], serial_quotients[3];
+
+	for (int i = 0; i < 3; i++) {
+		parallel_u[i] = random_bigint(parallel_sizes[i]);
+		parallel_v[i] = random_bigint(parallel_sizes[i] - 7, true);
+		serial_products[i] = parallel_u[i] * parallel_v[i];
+		serial_quotients[i] = serial_products[i] / (parallel_u[i] + 1);
+	}
+
+	algo::bigint::set_parallelism(4, 64);
+
+	auto big = int1 << 100000;
+
+	CHECK((big * big + big) % modulus == 94037702);
+
+	{
+		algo::bigint::Pool shared;
+		algo::bigint::ResourceScope scope(&shared);
+
+		for (int i = 0; i < 3; i++) {
+			CHECK(parallel_u[i] * parallel_v[i] == serial_products[i]);
+			CHECK(serial_products[i] / (parallel_u[i] + 1) == serial_quotients[i]);
+		}
+	}
+
+	algo::bigint::set_parallelism(1);
+
+	auto batch = algo::bigint::Batch(8, 20);
+	auto sums = algo::bigint::Batch(8, 20);
+
+	for (int i = 0; i < 20; i++) {
+		batch.set(i, int1 * int2 * int2);
+	}
+	algo::bigint::batch_mul_add(batch, batch, sums);
+	algo::bigint::batch_add(sums, batch, sums);
+
+	auto lane = int1 * int2 * int2 % (algo::bigint::BigInt(1) << 256) + (algo::bigint::BigInt(1) << 256);
+
+	CHECK(sums.get(19) == (lane * lane + lane) % (algo::bigint::BigInt(1) << 256));
+
+	//every batch operation lane by lane against BigInt arithmetic modulo
+	//2^(32 * limbs), with lane counts around the AVX2 and AVX-512 widths
+	//and sums written over an operand
+	int lane_counts[] = { 1, 7, 8, 9, 16, 17, 33 };
+	int lane_widths[] = { 1, 3, 8 };
+
+	for (int count : lane_counts) {
+		for (int width : lane_widths) {
+			auto wrap = algo::bigint::BigInt(1) << (32 * width);
+			algo::bigint::Batch u(width, count), v(width, count), w(width, count), acc(width, count);
+			std::vector<algo::bigint::BigInt> us, vs, accs;
+
+			for (int i = 0; i < count; i++) {
+				us.push_back(random_bigint(1 + i % width, i % 3 == 0) % wrap);
+				vs.push_back(random_bigint(1 + (i + 1) % width) % wrap);
+				accs.push_back(random_bigint(width));
+				u.set(i, us[i]);
+				v.set(i, vs[i]);
+				acc.set(i, accs[i]);
+				us[i] = (us[i] + wrap) % wrap;
+			}
+
+			algo::bigint::batch_mul_add(u, v, acc);
+			for (int i = 0; i < count; i++) {
+				CHECK(acc.get(i) == (accs[i] + us[i] * vs[i]) % wrap);
+			}
+
+			algo::bigint::batch_mul(u, v, w);
+			for (int i = 0; i < count; i++) {
+				CHECK(w.get(i) == us[i] * vs[i] % wrap);
+			}
+
+			algo::bigint::batch_sub(u, v, w);
+			for (int i = 0; i < count; i++) {
+				CHECK(w.get(i) == (us[i] - vs[i] + wrap) % wrap);
+			}
+
+			algo::bigint::batch_add(u, v, u);
+			for (int i = 0; i < count; i++) {
+				CHECK(u.get(i) == (us[i] + vs[i]) % wrap);
+			}
+		}
+	}
+
+	algo::bigint::BigInt x, y;
+	auto u = int1 * int2 * 6;
+	auto v = int2 * modulus * 4;
+	auto g = algo::bigint::xgcd(u, v, x, y);
+
+	CHECK(g == 400000000000 && u * x + v * y == g);
+	CHECK(algo::bigint::modinv(int1, modulus) == 81428572);
+
+	//gcd, xgcd and modinv from one limb through the two-limb word path to
+	//many Lehmer steps, with signs, zeros and a known common factor, and
+	//consecutive Fibonacci numbers as the worst case for the quotients
+	int gcd_sizes[] = { 1, 2, 3, 4, 40, 300 };
+	algo::bigint::BigInt fib_a = 1, fib_b = 1;
+
+	for (int i = 0; i < 3000; i++) {
+		fib_a += fib_b;
+		std::swap(fib_a, fib_b);
+	}
+	CHECK(algo::bigint::gcd(fib_a, fib_b) == 1);
+	CHECK(algo::bigint::xgcd(fib_b, fib_a, x, y) == 1 && fib_b * x + fib_a * y == 1);
+
+	for (int n : gcd_sizes) {
+		auto a = random_bigint(n, true), b = random_bigint(n + n / 2), c = random_bigint(n / 2 + 1);
+		auto ac = a * c, bc = b * c;
+		auto common = algo::bigint::gcd(ac, bc);
+		auto coprime = b;
+
+		for (auto d = algo::bigint::gcd(a, coprime); d != 1; d = algo::bigint::gcd(a, coprime)) {
+			coprime /= d;
+		}
+
+		auto inverse = algo::bigint::modinv(a, coprime);
+
+		CHECK(common % c == 0 && ac % common == 0 && bc % common == 0);
+		CHECK(algo::bigint::gcd(ac / common, bc / common) == 1 && common == c * algo::bigint::gcd(a, b));
+		CHECK(algo::bigint::xgcd(ac, bc, x, y) == common && ac * x + bc * y == common);
+		CHECK(algo::bigint::xgcd(bc, ac, x, y) == common && bc * x + ac * y == common);
+		CHECK(algo::bigint::gcd(a, 0) == a * -1 && algo::bigint::gcd(0, b) == b && algo::bigint::gcd(a, a) == a * -1);
+		CHECK(inverse >= 0 && inverse < coprime && (a * inverse - 1) % coprime == 0);
+	}
+	CHECK(algo::bigint::gcd(0, 0) == 0);
+
+	try {
+		algo::bigint::modinv(6, 9);
+		CHECK(!"modinv(6, 9) must throw");
+	} catch (std::invalid_argument &) {
+	}
+
+	CHECK(algo::bigint::square(u) == algo::bigint::BigInt("3600000000000000000000000000000000000000000000"));
+
+	//square(), x * x and x *= x on both sides of the squaring kernel's
+	//range and through the Karatsuba, Toom-3 and NTT squares, against the
+	//general product of x with a copy of itself
+	int square_sizes[] = { 1, 2, 11, 12, 13, 127, 128, 129, 240, 1500 };
+
+	for (int n : square_sizes) {
+		auto a = random_bigint(n, n & 1);
+		auto copy = a;
+		auto product = a * copy;
+		auto x = a;
+
+		x *= x;
+		CHECK(algo::bigint::square(a) == product && a * a == product && x == product);
+	}
+	CHECK(7 - (u + 1) / 1000003 % -999 == -411);
+
+	//native operands of several widths and both signs, the extremes
+	//included, on either side of each operator against BigInts parsed
+	//from their text; bool and the character types do not convert
+	static_assert(!std::is_convertible<char, algo::bigint::BigInt>::value, "char converts");
+	static_assert(!std::is_convertible<wchar_t, algo::bigint::BigInt>::value, "wchar_t converts");
+	static_assert(!std::is_convertible<char32_t, algo::bigint::BigInt>::value, "char32_t converts");
+	static_assert(!std::is_convertible<bool, algo::bigint::BigInt>::value, "bool converts");
+	static_assert(std::is_convertible<int8_t, algo::bigint::BigInt>::value, "int8_t does not convert");
+	static_assert(std::is_convertible<uint64_t, algo::bigint::BigInt>::value, "uint64_t does not convert");
+
+	int64_t signed_scalars[] = { INT64_MIN, INT64_MIN + 1, -4294967296LL, -7, -1, 0, 1, 3, 4294967295LL, INT64_MAX };
+	uint64_t unsigned_scalars[] = { 0, 1, 4294967296ULL, UINT64_MAX };
+
+	for (int n : { 1, 2, 5 }) {
+		auto a = random_bigint(n, n == 2);
+
+		for (int64_t k : signed_scalars) {
+			auto big_k = algo::bigint::BigInt(std::to_string(k).c_str());
+			auto big_int = algo::bigint::BigInt(std::to_string((int)k).c_str());
+			auto x = a;
+
+			CHECK(a + k == a + big_k && k + a == big_k + a && a - k == a - big_k && k - a == big_k - a);
+			CHECK(a * k == a * big_k && k * a == big_k * a && a * (int)k == a * big_int);
+			CHECK(k / a == big_k / a && k % a == big_k % a && (int)k - a == big_int - a);
+			CHECK((x += k) == a + big_k && (x -= k) == a && (x *= k) == a * big_k);
+
+			if (k != 0) {
+				CHECK(a / k == a / big_k && a % k == a % big_k);
+				CHECK((int)k == 0 || (a / (int)k == a / big_int && a % (int)k == a % big_int));
+			}
+		}
+
+		for (uint64_t k : unsigned_scalars) {
+			auto big_k = algo::bigint::BigInt(std::to_string(k).c_str());
+
+			CHECK(a + k == a + big_k && k - a == big_k - a && a * k == a * big_k);
+			CHECK(k == 0 || (a / k == a / big_k && a % k == a % big_k));
+			CHECK(a * (uint8_t)k == a * (k & 255) && a - (int8_t)-5 == a + 5);
+		}
+	}
+
+	auto acc = u;
+
+	acc.addmul(v, 3);
+	acc.submul(int1, int2);
+	CHECK(acc == u + v * 3 - int1 * int2);
+
+	//against += u * v and -= u * v with the rows accumulated in place
+	//and with the product from the workspace, signs that cancel, an
+	//accumulator shorter than the product, aliasing and native operands
+	for (int n : { 1, 2, 5, 47, 48, 49, 60, 250 }) {
+		for (int m : { 1, n / 2 + 1, n }) {
+			auto x = random_bigint(n, n % 2 == 0);
+			auto y = random_bigint(m, m % 3 == 0);
+			auto z = random_bigint(n + m + 1, true);
+
+			for (auto start : { z, algo::bigint::BigInt(), algo::bigint::BigInt(7), x * y }) {
+				auto sum = start, difference = start, expected = start;
+
+				CHECK(sum.addmul(x, y) == (expected += x * y));
+				CHECK(difference.submul(x, y) == start - x * y);
+				CHECK(difference.addmul(y, x) == start && sum.submul(x * -1, y) == expected + x * y);
+			}
+
+			auto self = x;
+
+			CHECK(self.addmul(self, y) == x + x * y && self.submul(y, self) == (x + x * y) * (1 - y));
+			self = z;
+			CHECK(self.addmul(self, self) == z + z * z);
+			self = z;
+			CHECK(self.submul(self, self) == z - z * z);
+
+			auto native = z;
+
+			CHECK(native.addmul(x, -5) == z - x * 5 && native.submul(x, UINT64_MAX) == z - x * 5 - x * UINT64_MAX);
+		}
+	}
+
+	auto cube = algo::bigint::pow(int1, 3);
+
+	auto root = algo::bigint::isqrt(u * modulus);
+
+	CHECK(cube == int1 * int1 * int1 && algo::bigint::iroot(cube, 3) == int1);
+	CHECK(root * root <= u * modulus && (root + 1) * (root + 1) > u * modulus);
+
+	//pow against repeated multiplication, with a power of two in the base,
+	//and roots bracketed by powers on both sides of the bit-by-bit, 64-bit
+	//and Newton ranges, perfect powers and their neighbours included
+	size_t root_bits[] = { 1, 31, 32, 33, 63, 64, 65, 200, 5000 };
+	int root_degrees[] = { 2, 3, 5, 17 };
+
+	for (size_t bits : root_bits) {
+		auto n = (random_bigint((bits + 31) / 32) % (algo::bigint::BigInt(1) << bits)) | algo::bigint::BigInt(1) << (bits - 1);
+		algo::bigint::BigInt power = 1;
+		auto r = algo::bigint::isqrt(n);
+
+		CHECK(r * r <= n && (r + 1) * (r + 1) > n);
+		CHECK(algo::bigint::isqrt(n * n) == n && algo::bigint::isqrt(n * n - 1) == n - 1);
+
+		for (int k : root_degrees) {
+			r = algo::bigint::iroot(n, k);
+
+			CHECK(algo::bigint::pow(r, k) <= n && algo::bigint::pow(r + 1, k) > n);
+			CHECK(algo::bigint::iroot(algo::bigint::pow(n, k), k) == n && algo::bigint::iroot(algo::bigint::pow(n, k) - 1, k) == n - 1);
+			CHECK(k % 2 == 0 || algo::bigint::iroot(n * -1, k) == r * -1);
+		}
+
+		for (uint64_t e = 0; e <= 20; e++) {
+			CHECK(algo::bigint::pow(n, e) == power && algo::bigint::pow(n << 7, e) == power << (7 * e));
+			power *= n;
+		}
+	}
+	CHECK(algo::bigint::pow(0, 0) == 1 && algo::bigint::pow(-3, 4) == 81);
+	CHECK(algo::bigint::pow(-2, 63) + (algo::bigint::BigInt(1) << 63) == 0);
+	CHECK(algo::bigint::pow(1, UINT64_MAX) == 1 && algo::bigint::pow(-1, UINT64_MAX) == -1);
+
+	//exponents whose product with the base's length wraps 64 bits, on a
+	//power of two and on an odd base
+	for (const char *huge : { "4", "-2", "12", "3", "1099511627776" }) {
+		for (uint64_t e : { (uint64_t)1 << 63, (uint64_t)1 << 62, UINT64_MAX, (uint64_t)1 << 31 }) {
+			try {
+				algo::bigint::pow(algo::bigint::BigInt(huge), e);
+				CHECK(!"pow must reject a result this large");
+			} catch (std::invalid_argument &) {
+			}
+		}
+	}
+	CHECK(algo::bigint::factorial(30) == algo::bigint::BigInt("265252859812191058636308480000000"));
+	CHECK(algo::bigint::binomial(60, 30) == algo::bigint::BigInt("118264581564861424"));
+
+	//trees of factors against a running product, factorials on either
+	//side of the leaf ranges of 16, Pascal's rule and the series of e
+	std::vector<algo::bigint::BigInt> factors;
+	algo::bigint::BigInt running = 1;
+
+	for (int count = 0; count <= 100; count++) {
+		CHECK(algo::bigint::product(factors.data(), count) == running);
+		factors.push_back(random_bigint(count % 7 + 1, count % 3 == 0));
+		running *= factors.back();
+	}
+
+	running = 1;
+	for (uint64_t n = 0; n <= 600; n++) {
+		if (n > 0) {
+			running *= n;
+		}
+		if (n <= 80 || n % 97 == 0) {
+			CHECK(algo::bigint::factorial(n) == running);
+		}
+	}
+
+	for (uint64_t n = 1; n <= 70; n += 3) {
+		for (uint64_t k = 0; k <= n + 1; k++) {
+			auto c = algo::bigint::binomial(n, k);
+
+			CHECK(k > n ? c == 0 : c == algo::bigint::binomial(n, n - k));
+			CHECK(k == 0 || k > n || c == algo::bigint::binomial(n - 1, k - 1) + algo::bigint::binomial(n - 1, k));
+		}
+	}
+	CHECK(algo::bigint::binomial(300, 120) * algo::bigint::factorial(120) * algo::bigint::factorial(180) == algo::bigint::factorial(300));
+
+	for (uint64_t b : { 2, 3, 17, 18, 40 }) {
+		auto terms = algo::bigint::binary_split(1, b,
+			[](uint64_t) { return 1; },
+			[](uint64_t k) { return k; },
+			[](uint64_t k) { return k + 1; });
+		algo::bigint::BigInt sum;
+
+		for (uint64_t k = 1; k < b; k++) {
+			sum += algo::bigint::factorial(b - 1) / algo::bigint::factorial(k) * (k + 1);
+		}
+		CHECK(terms.p == 1 && terms.q == algo::bigint::factorial(b - 1) && terms.t == sum);
+	}
+
+	try {
+		algo::bigint::binary_split(5, 5, [](uint64_t) { return 1; }, [](uint64_t) { return 1; }, [](uint64_t) { return 1; });
+		CHECK(!"binary_split(5, 5) must throw");
+	} catch (std::invalid_argument &) {
+	}
+
+	std::stringstream text;
+	algo::bigint::BigInt parsed;
+
+	text << cube << " " << -7;
+	text >> parsed;
+	CHECK(parsed == cube && text.good());
+	text >> parsed;
+	CHECK(parsed == -7 && text.eof() && !text.fail());
+
+	//>> stops at the first other character and fails without a digit,
+	//leaving x as it was
+	for (const char *bad : { "", "  ", "x1", "-", "- 1", "--1" }) {
+		std::stringstream in(bad);
+
+		parsed = 5;
+		in >> parsed;
+		CHECK(in.fail() && parsed == 5);
+	}
+	text.clear();
+	text.str(" \n-0012x 3");
+	text >> parsed;
+	CHECK(parsed == -12 && text.get() == 'x' && text >> parsed && parsed == 3);
+
+	//whole numbers of digit blocks and a digit either side of them, fed
+	//and drained in pieces of one byte, a few and a buffer's worth, and
+	//through a pipe
+	uint64_t digit_state = 12345;
+
+	for (int d : { 1, 9, 10, 2303, 2304, 2305, 4608, 4609, 20000 }) {
+		std::string digits;
+
+		for (int i = 0; i < d; i++) {
+			digit_state = digit_state * 6364136223846793005ULL + 1442695040888963407ULL;
+			digits.push_back('0' + (char)((digit_state >> 33) % 10));
+		}
+		digits[0] = digits[0] == '0' ? '7' : digits[0];
+
+		for (bool negative : { false, true }) {
+			std::string expected = (negative ? "-" : "") + digits;
+			std::string framed = "\t " + expected + "\n";
+			auto x = algo::bigint::BigInt(expected.c_str());
+			std::stringstream out;
+			std::string written;
+			int fds[2];
+
+			CHECK(x.to_string() == expected && (out << x, out.str()) == expected);
+			CHECK(out >> parsed && parsed == x && out.eof());
+
+			for (size_t chunk : { (size_t)1, (size_t)7, (size_t)65536 }) {
+				size_t at = 0;
+
+				auto read = algo::bigint::read_decimal([&](char *buffer, size_t size) {
+					size_t n = std::min({ size, chunk, framed.size() - at });
+
+					framed.copy(buffer, n, at);
+					at += n;
+					return n;
+				});
+				CHECK(read == x);
+			}
+
+			algo::bigint::write_decimal(x, [&written](const char *data, size_t size) {
+				written.append(data, size);
+			});
+			CHECK(written == expected);
+
+			if (pipe(fds) == 0) {
+				CHECK(write(fds[1], framed.data(), framed.size()) == (ssize_t)framed.size());
+				close(fds[1]);
+				CHECK(algo::bigint::read_decimal(fds[0]) == x);
+				close(fds[0]);
+			}
+		}
+	}
+
+	for (const char *bad : { "12 34", "1a", "-", "1-" }) {
+		std::string source = bad;
+
+		try {
+			algo::bigint::read_decimal([&source](char *buffer, size_t size) {
+				size_t n = source.copy(buffer, size);
+
+				source.erase(0, n);
+				return n;
+			});
+			CHECK(!"read_decimal must reject the text");
+		} catch (std::invalid_argument &) {
+		}
+	}
+
+	//left running, so the workers are joined at exit
+	algo::bigint::set_parallelism(2);
+
+	return failures != 0;
 }